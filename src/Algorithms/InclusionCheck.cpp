@@ -0,0 +1,279 @@
+#include "InclusionCheck.h"
+
+/*
+ * @param a Automaton A (states numbered from 0, symbols shared with B)
+ * @param b Automaton B (states numbered from 0, symbols shared with A)
+ * @param spec Automaton B used for the complementation
+ */
+InclusionCheck::InclusionCheck(BuchiAutomaton<int, int>& a, BuchiAutomaton<int, int>& b, BuchiAutomatonSpec& spec)
+  : autA(a), autB(b), specB(spec), codec(), prefix(), loop(), explored(0), pruned(0), fallback(false)
+{
+  this->autA.freezeTransitions();
+}
+
+
+/*
+ * Hashable key of a product state
+ * @param st Product state
+ * @return Key
+ */
+InclKey InclusionCheck::getKey(const InclState& st) const
+{
+  return { st.q, st.k, this->codec.encode(st.c) };
+}
+
+
+/*
+ * Is a product state accepting
+ * @param st Product state
+ * @return Accepting state of A with the flag waiting for A
+ */
+bool InclusionCheck::isAccepting(const InclState& st)
+{
+  return st.k == 0 && this->autA.getFinals().find(st.q) != this->autA.getFinals().end();
+}
+
+
+/*
+ * Successors of a product state
+ * @param st Product state
+ * @return Pairs (symbol, successor)
+ */
+vector<std::pair<int, InclState>> InclusionCheck::post(InclState& st)
+{
+  vector<std::pair<int, InclState>> ret;
+  const DeltaCSR& csr = this->autA.getTransitionsCSR();
+  bool finA = this->autA.getFinals().find(st.q) != this->autA.getFinals().end();
+  int k = st.k == 0 ? (finA ? 1 : 0) : (this->specB.isAccepting(st.c) ? 0 : 1);
+
+  for(int sym : this->autA.getAlphabet())
+  {
+    StateRange dst = csr.successors(st.q, sym);
+    if(dst.empty())
+      continue;
+    vector<StateSch> csucc = this->specB.successors(st.c, sym);
+    for(int q : dst)
+    {
+      for(const StateSch& c : csucc)
+        ret.push_back({sym, {q, c, k}});
+    }
+  }
+  return ret;
+}
+
+
+/*
+ * Nested DFS (blue DFS with cyan states on the stack, red DFS from accepting
+ * states in postorder) over the product of A with the complement of B.
+ * @param subsumption Prune subsumed tight states in the blue DFS
+ * @return Was an accepting lasso found (stored in prefix and loop)
+ */
+bool InclusionCheck::search(bool subsumption)
+{
+  struct Frame
+  {
+    InclState st;
+    int sym;
+    vector<std::pair<int, InclState>> succ;
+    size_t ind;
+  };
+
+  // cyan states (position on the stack), blue and red states
+  std::unordered_map<InclKey, size_t, InclKeyHash> onStack;
+  std::unordered_set<InclKey, InclKeyHash> blue;
+  std::unordered_set<InclKey, InclKeyHash> red;
+  map<SubsumptionKey, vector<RankFunc>> visitedRanks;
+  vector<Frame> stack;
+  vector<Frame> rstack;
+
+  auto subKey = [](const InclState& st) -> SubsumptionKey {
+    return std::make_tuple(st.q, st.k, st.c.S, st.c.O, st.c.i, st.c.f.getMaxRank());
+  };
+  auto isSubsumed = [&](InclState& st) {
+    if(!st.c.tight)
+      return false;
+    auto it = visitedRanks.find(subKey(st));
+    if(it == visitedRanks.end())
+      return false;
+    for(const RankFunc& g : it->second)
+    {
+      if(st.c.f.isAllLeq(g))
+        return true;
+    }
+    return false;
+  };
+  auto push = [&](InclState& st, int sym) {
+    this->explored++;
+    onStack[getKey(st)] = stack.size();
+    if(subsumption && st.c.tight)
+      visitedRanks[subKey(st)].push_back(st.c.f);
+    stack.push_back({st, sym, post(st), 0});
+  };
+
+  // red DFS from the top of the stack looking for a cyan state
+  auto redSearch = [&]() {
+    rstack.clear();
+    rstack.push_back({stack.back().st, -1, post(stack.back().st), 0});
+    while(!rstack.empty())
+    {
+      Frame& fr = rstack.back();
+      if(fr.ind == fr.succ.size())
+      {
+        rstack.pop_back();
+        continue;
+      }
+      std::pair<int, InclState> pr = fr.succ[fr.ind++];
+      InclKey key = getKey(pr.second);
+      auto it = onStack.find(key);
+      if(it != onStack.end())
+      {
+        // prefix leads to the cyan state, loop goes through the seed back to it
+        this->prefix.clear();
+        this->loop.clear();
+        for(size_t i = 1; i <= it->second; i++)
+          this->prefix.push_back(stack[i].sym);
+        for(size_t i = it->second + 1; i < stack.size(); i++)
+          this->loop.push_back(stack[i].sym);
+        for(size_t i = 1; i < rstack.size(); i++)
+          this->loop.push_back(rstack[i].sym);
+        this->loop.push_back(pr.first);
+        return true;
+      }
+      if(red.insert(key).second)
+      {
+        vector<std::pair<int, InclState>> succ = post(pr.second);
+        rstack.push_back({pr.second, pr.first, succ, 0});
+      }
+    }
+    return false;
+  };
+
+  StateSch cinit = this->specB.initial();
+  for(int q0 : this->autA.getInitials())
+  {
+    InclState init = {q0, cinit, 0};
+    if(blue.find(getKey(init)) != blue.end())
+      continue;
+    push(init, -1);
+    while(!stack.empty())
+    {
+      Frame& fr = stack.back();
+      if(fr.ind < fr.succ.size())
+      {
+        std::pair<int, InclState> pr = fr.succ[fr.ind++];
+        InclKey key = getKey(pr.second);
+        if(blue.find(key) != blue.end() || onStack.find(key) != onStack.end())
+          continue;
+        if(subsumption && isSubsumed(pr.second))
+        {
+          this->pruned++;
+          continue;
+        }
+        push(pr.second, pr.first);
+        continue;
+      }
+
+      // postorder
+      if(isAccepting(fr.st) && redSearch())
+        return true;
+      InclKey key = getKey(fr.st);
+      onStack.erase(key);
+      blue.insert(key);
+      stack.pop_back();
+    }
+  }
+  return false;
+}
+
+
+/*
+ * Check the inclusion L(A) \subseteq L(B). A lasso found with the pruning is
+ * verified on A and B; if the pruning was used and no (verified) lasso was
+ * found, the exact search (without pruning) is run.
+ * @param stats Statistics of the preprocessing of the complementation
+ * @param subsumption Use the pruning of subsumed states
+ * @return Is the language of A included in the language of B
+ */
+bool InclusionCheck::isIncluded(Stat* stats, bool subsumption)
+{
+  this->specB.prepareSchReduced(false, this->autB.getFinals(), 0.5, oldVersion, false, false, stats);
+  this->codec = this->specB.getImplicitCodec();
+  this->explored = this->pruned = 0;
+  this->fallback = false;
+
+  bool found = search(subsumption);
+  if(found && acceptsLasso(this->autA, this->prefix, this->loop) &&
+    !acceptsLasso(this->autB, this->prefix, this->loop))
+    return false;
+  if(!subsumption || (!found && this->pruned == 0))
+    return !found;
+
+  this->fallback = true;
+  return !search(false);
+}
+
+
+/*
+ * Is an ultimately periodic word prefix.loop^omega accepted by an automaton
+ * @param aut Buchi automaton
+ * @param prefix Prefix of the word
+ * @param loop Loop of the word (nonempty)
+ * @return Is the word accepted
+ */
+bool InclusionCheck::acceptsLasso(BuchiAutomaton<int, int>& aut, const vector<int>& prefix, const vector<int>& loop)
+{
+  vector<int> word(prefix);
+  word.insert(word.end(), loop.begin(), loop.end());
+  size_t n = word.size();
+  auto next = [&](size_t pos) { return pos + 1 < n ? pos + 1 : prefix.size(); };
+  auto succ = [&](const pair<int, size_t>& v) {
+    vector<pair<int, size_t>> ret;
+    auto it = aut.getTransitions().find({v.first, word[v.second]});
+    if(it != aut.getTransitions().end())
+    {
+      for(int d : it->second)
+        ret.push_back({d, next(v.second)});
+    }
+    return ret;
+  };
+
+  // reachable vertices of the product with the word
+  set<pair<int, size_t>> reach;
+  vector<pair<int, size_t>> stack;
+  for(int q : aut.getInitials())
+  {
+    if(reach.insert({q, 0}).second)
+      stack.push_back({q, 0});
+  }
+  while(!stack.empty())
+  {
+    pair<int, size_t> v = stack.back();
+    stack.pop_back();
+    for(const auto& d : succ(v))
+    {
+      if(reach.insert(d).second)
+        stack.push_back(d);
+    }
+  }
+
+  // accepting vertex on a cycle
+  for(const auto& v : reach)
+  {
+    if(aut.getFinals().find(v.first) == aut.getFinals().end())
+      continue;
+    set<pair<int, size_t>> visited;
+    stack = succ(v);
+    while(!stack.empty())
+    {
+      pair<int, size_t> u = stack.back();
+      stack.pop_back();
+      if(u == v)
+        return true;
+      if(!visited.insert(u).second)
+        continue;
+      for(const auto& d : succ(u))
+        stack.push_back(d);
+    }
+  }
+  return false;
+}
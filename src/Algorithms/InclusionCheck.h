@@ -0,0 +1,98 @@
+#ifndef _INCLUSION_CHECK_H_
+#define _INCLUSION_CHECK_H_
+
+#include <set>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../Automata/BuchiAutomaton.h"
+#include "../Complement/BuchiAutomatonSpec.h"
+#include "../Complement/PackedStateSch.h"
+#include "../Complement/StateSch.h"
+
+/*
+ * State of the product of A with the complement of B. The flag k
+ * degeneralizes the two acceptance conditions (k = 0 waits for an accepting
+ * state of A, k = 1 for an accepting state of the complement).
+ */
+struct InclState
+{
+  int q;
+  StateSch c;
+  int k;
+};
+
+/*
+ * Hashable key of a product state
+ */
+struct InclKey
+{
+  int q;
+  int k;
+  PackedStateSch c;
+
+  bool operator==(const InclKey& other) const
+  {
+    return this->q == other.q && this->k == other.k && this->c == other.c;
+  }
+};
+
+struct InclKeyHash
+{
+  size_t operator()(const InclKey& key) const
+  {
+    return key.c.hash ^ (std::hash<int>()(2*key.q + key.k) * 0x9e3779b97f4a7c15ULL);
+  }
+};
+
+/*
+ * Language inclusion L(A) \subseteq L(B) checked on the fly: the product of
+ * A with the complement of B (on-the-fly interface of BuchiAutomatonSpec) is
+ * explored by a nested DFS and the search stops at the first accepting lasso. Tight
+ * product states whose rank function is pointwise smaller than the rank
+ * function of an already visited state (with the same A-state, flag, S, O, i
+ * and max rank) are pruned.
+ */
+class InclusionCheck
+{
+private:
+  typedef std::tuple<int, int, set<int>, set<int>, int, int> SubsumptionKey;
+
+  BuchiAutomaton<int, int>& autA;
+  BuchiAutomaton<int, int>& autB;
+  BuchiAutomatonSpec& specB;
+  StateSchCodec codec;
+
+  vector<int> prefix;
+  vector<int> loop;
+  long explored;
+  long pruned;
+  bool fallback;
+
+  InclKey getKey(const InclState& st) const;
+  bool isAccepting(const InclState& st);
+  vector<std::pair<int, InclState>> post(InclState& st);
+  bool search(bool subsumption);
+
+public:
+  InclusionCheck(BuchiAutomaton<int, int>& a, BuchiAutomaton<int, int>& b, BuchiAutomatonSpec& spec);
+
+  bool isIncluded(Stat* stats, bool subsumption = true);
+  static bool acceptsLasso(BuchiAutomaton<int, int>& aut, const vector<int>& prefix, const vector<int>& loop);
+
+  /*
+   * Counterexample (prefix and loop of a word in L(A) \ L(B)) found by the
+   * last call of isIncluded
+   */
+  const vector<int>& getPrefix() const { return this->prefix; }
+  const vector<int>& getLoop() const { return this->loop; }
+
+  long getExplored() const { return this->explored; }
+  long getPruned() const { return this->pruned; }
+  bool usedFallback() const { return this->fallback; }
+};
+
+#endif
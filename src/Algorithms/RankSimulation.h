@@ -0,0 +1,308 @@
+#ifndef _RANK_SIMULATION_H_
+#define _RANK_SIMULATION_H_
+
+#include <set>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+/*
+ * Binary relation over states 0..n-1 stored as a bit matrix (row i contains
+ * all states j such that (i, j) is in the relation).
+ */
+class BitRelation
+{
+private:
+  size_t n;
+  size_t words;
+  std::vector<uint64_t> bits;
+
+public:
+  BitRelation() : n(0), words(0), bits() { }
+
+  /*
+   * @param n Number of states
+   */
+  BitRelation(size_t n) : n(n), words((n + 63) / 64), bits(n * ((n + 63) / 64), 0) { }
+
+  size_t size() const { return this->n; }
+  size_t wordCount() const { return this->words; }
+
+  uint64_t* row(size_t i) { return this->bits.data() + i*this->words; }
+  const uint64_t* row(size_t i) const { return this->bits.data() + i*this->words; }
+
+  bool contains(int i, int j) const
+  {
+    return (row(i)[j >> 6] >> (j & 63)) & 1;
+  }
+
+  void insert(int i, int j)
+  {
+    row(i)[j >> 6] |= uint64_t(1) << (j & 63);
+  }
+
+  void erase(int i, int j)
+  {
+    row(i)[j >> 6] &= ~(uint64_t(1) << (j & 63));
+  }
+
+  bool operator==(const BitRelation& other) const
+  {
+    return this->n == other.n && this->bits == other.bits;
+  }
+
+  /*
+   * Number of equivalence classes (components of the symmetric part of the
+   * relation) on a set of states
+   * @param st Set of states
+   * @return Number of classes
+   */
+  int countClasses(const std::set<int>& st) const
+  {
+    std::vector<int> elems(st.begin(), st.end());
+    std::vector<int> parent(elems.size());
+    for(size_t i = 0; i < elems.size(); i++)
+      parent[i] = i;
+    auto find = [&parent](int i) {
+      while(parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+      return i;
+    };
+
+    int classes = elems.size();
+    for(size_t i = 0; i < elems.size(); i++)
+    {
+      for(size_t j = i + 1; j < elems.size(); j++)
+      {
+        if(!contains(elems[i], elems[j]) || !contains(elems[j], elems[i]))
+          continue;
+        int a = find(i);
+        int b = find(j);
+        if(a != b)
+        {
+          parent[a] = b;
+          classes--;
+        }
+      }
+    }
+    return classes;
+  }
+
+  /*
+   * Call a function for each pair of the relation (in lexicographic order)
+   */
+  template <typename Fnc>
+  void forEach(Fnc fnc) const
+  {
+    for(size_t i = 0; i < this->n; i++)
+    {
+      const uint64_t* r = row(i);
+      for(size_t k = 0; k < this->words; k++)
+      {
+        uint64_t w = r[k];
+        while(w != 0)
+        {
+          fnc(int(i), int(k*64 + __builtin_ctzll(w)));
+          w &= w - 1;
+        }
+      }
+    }
+  }
+};
+
+/*
+ * Computation of the odd rank simulation of an automaton with states
+ * 0..n-1. The relation is the least relation containing a seed that is (i)
+ * transitive on a closure of states and (ii) contains each pair of nonfinal
+ * states (p, q) such that for each symbol all nonfinal successors of p are
+ * related with all nonfinal successors of q. Pairs are re-derived only if a
+ * pair of their successors was added (predecessor-driven worklist); the
+ * closure is computed by the bit-parallel Warshall algorithm.
+ */
+class RankSimulation
+{
+private:
+  size_t n;
+  size_t words;
+  std::vector<bool> fin;
+  // nonfinal successors and predecessors: [symbol][state]
+  std::vector<std::vector<std::vector<int>>> succ;
+  std::vector<std::vector<std::vector<int>>> pred;
+  // rows of nonfinal successors: [symbol][state * words]
+  std::vector<std::vector<uint64_t>> succMask;
+
+  /*
+   * Are all nonfinal successors of p related with all nonfinal successors of q
+   * (for all symbols)
+   */
+  bool derivable(const BitRelation& rel, int p, int q) const
+  {
+    for(size_t a = 0; a < this->succ.size(); a++)
+    {
+      const uint64_t* mq = this->succMask[a].data() + q*this->words;
+      for(int x : this->succ[a][p])
+      {
+        const uint64_t* rx = rel.row(x);
+        for(size_t k = 0; k < this->words; k++)
+        {
+          if(mq[k] & ~rx[k])
+            return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /*
+   * Warshall closure of the relation restricted to cl
+   * @param rel Relation (modified in place)
+   * @param cl Closure of states
+   * @param clMask Closure of states as a bitset
+   * @param added Out parameter collecting the new pairs
+   */
+  void closure(BitRelation& rel, const std::vector<int>& cl, const std::vector<uint64_t>& clMask,
+    std::vector<std::pair<int, int>>& added) const
+  {
+    std::vector<uint64_t> before(cl.size() * this->words);
+    for(size_t i = 0; i < cl.size(); i++)
+      std::copy(rel.row(cl[i]), rel.row(cl[i]) + this->words, before.begin() + i*this->words);
+
+    for(int k : cl)
+    {
+      const uint64_t* rk = rel.row(k);
+      for(int i : cl)
+      {
+        if(!rel.contains(i, k))
+          continue;
+        uint64_t* ri = rel.row(i);
+        for(size_t w = 0; w < this->words; w++)
+          ri[w] |= rk[w] & clMask[w];
+      }
+    }
+
+    for(size_t i = 0; i < cl.size(); i++)
+    {
+      const uint64_t* ri = rel.row(cl[i]);
+      for(size_t w = 0; w < this->words; w++)
+      {
+        uint64_t diff = ri[w] & ~before[i*this->words + w];
+        while(diff != 0)
+        {
+          added.push_back({cl[i], int(w*64 + __builtin_ctzll(diff))});
+          diff &= diff - 1;
+        }
+      }
+    }
+  }
+
+public:
+  RankSimulation() : n(0), words(0), fin(), succ(), pred(), succMask() { }
+
+  /*
+   * @param n Number of states
+   * @param finals Final states
+   * @param trans Successors of states: trans[symbol][state]
+   */
+  RankSimulation(size_t n, const std::set<int>& finals, const std::vector<std::vector<std::vector<int>>>& trans)
+    : n(n), words((n + 63) / 64), fin(n, false), succ(), pred(), succMask()
+  {
+    for(int f : finals)
+      this->fin[f] = true;
+    this->succ.assign(trans.size(), std::vector<std::vector<int>>(n));
+    this->pred.assign(trans.size(), std::vector<std::vector<int>>(n));
+    this->succMask.assign(trans.size(), std::vector<uint64_t>(n * this->words, 0));
+    for(size_t a = 0; a < trans.size(); a++)
+    {
+      for(size_t p = 0; p < trans[a].size(); p++)
+      {
+        for(int x : trans[a][p])
+        {
+          if(this->fin[x])
+            continue;
+          this->succ[a][p].push_back(x);
+          this->succMask[a][p*this->words + (x >> 6)] |= uint64_t(1) << (x & 63);
+          if(!this->fin[p])
+            this->pred[a][x].push_back(p);
+        }
+      }
+    }
+  }
+
+  /*
+   * Compute the odd rank simulation
+   * @param seed Initial relation (e.g., direct simulation)
+   * @param cl Closure of states
+   * @return Odd rank simulation
+   */
+  BitRelation compute(const BitRelation& seed, const std::set<int>& cl) const
+  {
+    BitRelation rel = seed;
+    BitRelation queued(this->n);
+    std::vector<std::pair<int, int>> worklist;
+    std::vector<std::pair<int, int>> added;
+    std::vector<int> clVec(cl.begin(), cl.end());
+    std::vector<uint64_t> clMask(this->words, 0);
+    for(int s : cl)
+      clMask[s >> 6] |= uint64_t(1) << (s & 63);
+
+    // pairs of predecessors of a new pair have to be checked again
+    auto enqueuePred = [&](int x, int y) {
+      if(this->fin[x] || this->fin[y])
+        return;
+      for(size_t a = 0; a < this->pred.size(); a++)
+      {
+        for(int p : this->pred[a][x])
+        {
+          for(int q : this->pred[a][y])
+          {
+            if(rel.contains(p, q) || queued.contains(p, q))
+              continue;
+            queued.insert(p, q);
+            worklist.push_back({p, q});
+          }
+        }
+      }
+    };
+
+    closure(rel, clVec, clMask, added);
+    added.clear();
+    for(size_t p = 0; p < this->n; p++)
+    {
+      for(size_t q = 0; q < this->n; q++)
+      {
+        if(this->fin[p] || this->fin[q] || rel.contains(p, q))
+          continue;
+        queued.insert(p, q);
+        worklist.push_back({p, q});
+      }
+    }
+
+    bool changed;
+    do
+    {
+      changed = false;
+      while(!worklist.empty())
+      {
+        std::pair<int, int> pr = worklist.back();
+        worklist.pop_back();
+        queued.erase(pr.first, pr.second);
+        if(rel.contains(pr.first, pr.second) || !derivable(rel, pr.first, pr.second))
+          continue;
+        rel.insert(pr.first, pr.second);
+        changed = true;
+        enqueuePred(pr.first, pr.second);
+      }
+      if(!changed)
+        break;
+
+      closure(rel, clVec, clMask, added);
+      for(const auto& pr : added)
+        enqueuePred(pr.first, pr.second);
+      changed = !added.empty();
+      added.clear();
+    } while(changed);
+    return rel;
+  }
+};
+
+#endif
@@ -111,3 +111,116 @@ string Simulations::execCmd(string& cmd)
   pclose(pipe);
   return result;
 }
+
+
+/*
+ * Compute the complement of the direct simulation of an automaton with
+ * states 0..n-1 (counting algorithm with flat counters over the CSR
+ * transitions). Missing transitions lead to an implicit nonaccepting sink
+ * with index n (the automaton is not copied).
+ * @param ba Buchi automaton (transitions are frozen)
+ * @return Pairs (p, q) such that q does not simulate p (states 0..n)
+ */
+BitRelation Simulations::computeDirectComplCSR(BuchiAutomaton<int, int>& ba)
+{
+  ba.freezeTransitions();
+  const DeltaCSR& csr = ba.getTransitionsCSR();
+  vector<int> syms(ba.getAlphabet().begin(), ba.getAlphabet().end());
+  size_t n = ba.getStates().size();
+  size_t sink = n;
+  size_t cnt = n + 1;
+
+  vector<bool> fin(cnt, false);
+  for(int f : ba.getFinals())
+    fin[f] = true;
+
+  // number of successors of each state (the sink replaces missing ones) and
+  // predecessors of the sink
+  vector<unsigned> succCount(syms.size() * cnt, 1);
+  vector<vector<int>> sinkPred(syms.size(), vector<int>({(int)sink}));
+  for(size_t a = 0; a < syms.size(); a++)
+  {
+    for(size_t k = 0; k < n; k++)
+    {
+      size_t s = csr.successors(k, syms[a]).size();
+      if(s == 0)
+        sinkPred[a].push_back(k);
+      else
+        succCount[a*cnt + k] = s;
+    }
+  }
+  auto pred = [&](size_t st, size_t a) -> StateRange {
+    if(st == sink)
+      return {sinkPred[a].data(), sinkPred[a].data() + sinkPred[a].size()};
+    return csr.predecessors(st, syms[a]);
+  };
+
+  // counter[(a*cnt + p)*cnt + k]: number of a-successors of k not simulating p
+  vector<unsigned> counter(syms.size() * cnt * cnt, 0);
+  BitRelation ret(cnt);
+  vector<pair<int, int>> proc;
+
+  for(size_t f = 0; f < n; f++)
+  {
+    if(!fin[f])
+      continue;
+    for(size_t nf = 0; nf < cnt; nf++)
+    {
+      if(fin[nf])
+        continue;
+      ret.insert(f, nf);
+      proc.push_back({f, nf});
+    }
+  }
+
+  while(!proc.empty())
+  {
+    pair<int, int> item = proc.back();
+    proc.pop_back();
+    for(size_t a = 0; a < syms.size(); a++)
+    {
+      StateRange predSecond = pred(item.second, a);
+      if(predSecond.empty())
+        continue;
+      StateRange predFirst = pred(item.first, a);
+      for(int k : predSecond)
+      {
+        unsigned& c = counter[(a*cnt + item.first)*cnt + k];
+        if(++c != succCount[a*cnt + k])
+          continue;
+        for(int m : predFirst)
+        {
+          if(!ret.contains(m, k))
+          {
+            ret.insert(m, k);
+            proc.push_back({m, k});
+          }
+        }
+      }
+    }
+  }
+  return ret;
+}
+
+
+/*
+ * Compute direct simulation of an automaton with states 0..n-1 (the
+ * automaton is implicitly completed by a nonaccepting sink)
+ * @param ba Buchi automaton (transitions are frozen)
+ * @return Direct simulation
+ */
+Relation<int> Simulations::directSimulation(BuchiAutomaton<int, int>& ba)
+{
+  BitRelation comp = computeDirectComplCSR(ba);
+  Relation<int> dir;
+  int n = ba.getStates().size();
+  for(int s1 = 0; s1 < n; s1++)
+  {
+    for(int s2 = 0; s2 < n; s2++)
+    {
+      if(!comp.contains(s1, s2))
+        dir.insert(dir.end(), {s1, s2});
+    }
+  }
+  return dir;
+}
@@ -55,6 +55,8 @@ public:
   static string execCmdTO(string& cmd, int timeout = 1000);
   static string execCmd(string& cmd);
 
+  Relation<int> directSimulation(BuchiAutomaton<int, int>& ba);
+
   /*
    * Compute direct simulation
    * @param ba Buchi automaton
@@ -81,6 +83,7 @@ public:
   };
 
 protected:
+  BitRelation computeDirectComplCSR(BuchiAutomaton<int, int>& ba);
 
   /*
    * Compute complement of direct simulation
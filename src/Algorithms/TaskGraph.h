@@ -0,0 +1,255 @@
+#ifndef _TASK_GRAPH_H_
+#define _TASK_GRAPH_H_
+
+#include <ctime>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+/*
+ * Graph of tasks with dependencies executed by a pool of threads. A task is
+ * started once all its dependencies are finished. Wall time and CPU time
+ * (in milliseconds) are recorded for each task; the CPU time includes the
+ * time of helper threads started by the task via parallelFor.
+ */
+class TaskGraph
+{
+public:
+  typedef std::function<void()> Task;
+
+  struct Timing
+  {
+    long wall;
+    long cpu;
+  };
+
+private:
+  struct Node
+  {
+    Task run;
+    std::vector<int> succ;
+    int waiting;
+    Timing time;
+    // CPU time of the task in microseconds (added by helper threads as well)
+    std::atomic<long> cpu;
+  };
+
+  std::vector<std::unique_ptr<Node>> nodes;
+
+  // CPU time accumulator of the task the current thread works for
+  static std::atomic<long>*& cpuSink()
+  {
+    static thread_local std::atomic<long>* sink = nullptr;
+    return sink;
+  }
+
+  void execute(int id)
+  {
+    Node& node = *this->nodes[id];
+    std::atomic<long>*& sink = cpuSink();
+    std::atomic<long>* prev = sink;
+    sink = &node.cpu;
+    auto start = std::chrono::high_resolution_clock::now();
+    long cpuStart = threadCpuTime();
+    try
+    {
+      node.run();
+    }
+    catch(...)
+    {
+      sink = prev;
+      throw;
+    }
+    node.cpu += threadCpuTime() - cpuStart;
+    auto end = std::chrono::high_resolution_clock::now();
+    sink = prev;
+    node.time.wall = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+    node.time.cpu = node.cpu.load() / 1000;
+  }
+
+public:
+  TaskGraph() : nodes() { }
+
+  /*
+   * CPU time of the calling thread
+   * @return CPU time in microseconds
+   */
+  static long threadCpuTime()
+  {
+    timespec ts;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+      return 0;
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+  }
+
+  /*
+   * Run tasks 0, ..., tasks-1 on workers threads (the calling thread is one
+   * of them). Tasks are taken dynamically one by one, so tasks of different
+   * costs are balanced. An exception thrown by a task is rethrown after all
+   * threads finish.
+   * @param workers Number of threads
+   * @param tasks Number of tasks
+   * @param run Task to be run for each index
+   */
+  static void parallelFor(unsigned workers, size_t tasks, const std::function<void(size_t)>& run)
+  {
+    if(workers <= 1 || tasks <= 1)
+    {
+      for(size_t i = 0; i < tasks; i++)
+        run(i);
+      return;
+    }
+    std::atomic<size_t> nextTask(0);
+    std::atomic<bool> failed(false);
+    std::vector<std::exception_ptr> errors(workers);
+    std::atomic<long>* sink = cpuSink();
+    auto worker = [&](unsigned w) {
+      try
+      {
+        for(size_t i = nextTask++; i < tasks && !failed.load(); i = nextTask++)
+          run(i);
+      }
+      catch(...)
+      {
+        errors[w] = std::current_exception();
+        failed = true;
+      }
+    };
+
+    std::vector<std::thread> pool;
+    for(unsigned w = 1; w < workers && w < tasks; w++)
+    {
+      pool.push_back(std::thread([&, w]() {
+        cpuSink() = sink;
+        long cpuStart = threadCpuTime();
+        worker(w);
+        if(sink != nullptr)
+          *sink += threadCpuTime() - cpuStart;
+      }));
+    }
+    worker(0);
+    for(std::thread& t : pool)
+      t.join();
+    for(const std::exception_ptr& e : errors)
+    {
+      if(e)
+        std::rethrow_exception(e);
+    }
+  }
+
+  /*
+   * Add a task
+   * @param run Task
+   * @param deps Tasks that have to be finished before the task starts
+   * @return Id of the task
+   */
+  int add(const Task& run, const std::vector<int>& deps = std::vector<int>())
+  {
+    int id = this->nodes.size();
+    this->nodes.push_back(std::unique_ptr<Node>(new Node()));
+    Node& node = *this->nodes.back();
+    node.run = run;
+    node.waiting = deps.size();
+    node.time = { 0, 0 };
+    node.cpu = 0;
+    for(int d : deps)
+      this->nodes[d]->succ.push_back(id);
+    return id;
+  }
+
+  /*
+   * Run all tasks. With a single worker the tasks are run in the order of
+   * insertion (a task can depend only on previously added tasks). An
+   * exception thrown by a task stops starting of new tasks and is rethrown
+   * after the running tasks finish.
+   * @param workers Number of threads
+   */
+  void run(unsigned workers)
+  {
+    if(workers <= 1)
+    {
+      for(size_t i = 0; i < this->nodes.size(); i++)
+        this->execute(i);
+      return;
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<int> ready;
+    size_t finished = 0;
+    size_t running = 0;
+    std::exception_ptr error;
+    for(size_t i = 0; i < this->nodes.size(); i++)
+    {
+      if(this->nodes[i]->waiting == 0)
+        ready.push_back(i);
+    }
+
+    auto worker = [&]() {
+      std::unique_lock<std::mutex> lock(mtx);
+      while(true)
+      {
+        cv.wait(lock, [&]() {
+          return !ready.empty() || finished == this->nodes.size() || (error && running == 0);
+        });
+        if(ready.empty() || error)
+          break;
+        int id = ready.back();
+        ready.pop_back();
+        running++;
+        lock.unlock();
+        std::exception_ptr exc;
+        try
+        {
+          this->execute(id);
+        }
+        catch(...)
+        {
+          exc = std::current_exception();
+        }
+        lock.lock();
+        running--;
+        finished++;
+        if(exc && !error)
+          error = exc;
+        if(!exc)
+        {
+          for(int s : this->nodes[id]->succ)
+          {
+            if(--this->nodes[s]->waiting == 0)
+              ready.push_back(s);
+          }
+        }
+        cv.notify_all();
+      }
+      cv.notify_all();
+    };
+
+    std::vector<std::thread> pool;
+    for(unsigned w = 1; w < workers && w < this->nodes.size(); w++)
+      pool.push_back(std::thread(worker));
+    worker();
+    for(std::thread& t : pool)
+      t.join();
+    if(error)
+      std::rethrow_exception(error);
+  }
+
+  /*
+   * Get the wall and CPU time of a finished task
+   * @param id Id of the task
+   * @return Times in milliseconds
+   */
+  const Timing& getTiming(int id) const
+  {
+    return this->nodes[id]->time;
+  }
+};
+
+#endif
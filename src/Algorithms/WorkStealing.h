@@ -0,0 +1,149 @@
+#ifndef _WORK_STEALING_H_
+#define _WORK_STEALING_H_
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+/*
+ * Set of per-worker deques with work stealing. A worker takes items from the
+ * back of its own deque (depth-first) and steals from the front of the other
+ * deques. The exploration terminates when all deques are empty and no item is
+ * being processed. Workers without work sleep until an item is pushed or the
+ * work is done.
+ */
+template <typename Item>
+class WorkStealingQueues
+{
+private:
+  struct WorkerQueue
+  {
+    std::mutex lock;
+    std::deque<Item> items;
+  };
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  // number of pushed items that were not finished yet
+  std::atomic<long> pending;
+  std::atomic<bool> stopped;
+  // sleeping workers (a worker is counted before it checks the deques for
+  // the last time, so a push either is seen by the worker or wakes it)
+  std::mutex idleLock;
+  std::condition_variable idle;
+  std::atomic<unsigned> sleepers;
+
+  void wake(bool all)
+  {
+    std::lock_guard<std::mutex> guard(this->idleLock);
+    if(all)
+      this->idle.notify_all();
+    else
+      this->idle.notify_one();
+  }
+
+  bool popOwn(unsigned worker, Item& out)
+  {
+    WorkerQueue& q = *this->queues[worker];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if(q.items.empty())
+      return false;
+    out = std::move(q.items.back());
+    q.items.pop_back();
+    return true;
+  }
+
+  bool steal(unsigned worker, Item& out)
+  {
+    for(size_t k = 1; k < this->queues.size(); k++)
+    {
+      WorkerQueue& q = *this->queues[(worker + k) % this->queues.size()];
+      std::lock_guard<std::mutex> guard(q.lock);
+      if(q.items.empty())
+        continue;
+      out = std::move(q.items.front());
+      q.items.pop_front();
+      return true;
+    }
+    return false;
+  }
+
+public:
+  /*
+   * @param workers Number of workers
+   */
+  WorkStealingQueues(unsigned workers) : queues(), pending(0), stopped(false), idleLock(), idle(), sleepers(0)
+  {
+    for(unsigned i = 0; i < workers; i++)
+      this->queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+  }
+
+  /*
+   * Add an item to the deque of a worker
+   * @param worker Worker
+   * @param item Item to be processed
+   */
+  void push(unsigned worker, Item item)
+  {
+    this->pending++;
+    {
+      WorkerQueue& q = *this->queues[worker];
+      std::lock_guard<std::mutex> guard(q.lock);
+      q.items.push_back(std::move(item));
+    }
+    if(this->sleepers.load() > 0)
+      this->wake(false);
+  }
+
+  /*
+   * Get the next item for a worker (waits until an item is available or the
+   * whole work is done). Each obtained item has to be confirmed by done().
+   * @param worker Worker
+   * @param out Out parameter to store the item
+   * @return False if there is no work left (or the work was stopped)
+   */
+  bool next(unsigned worker, Item& out)
+  {
+    while(!this->stopped.load())
+    {
+      if(popOwn(worker, out) || steal(worker, out))
+        return true;
+      if(this->pending.load() == 0)
+        return false;
+
+      std::unique_lock<std::mutex> lk(this->idleLock);
+      this->sleepers++;
+      bool found = popOwn(worker, out) || steal(worker, out);
+      if(!found && !this->stopped.load() && this->pending.load() != 0)
+        this->idle.wait(lk);
+      this->sleepers--;
+      if(found)
+        return true;
+    }
+    return false;
+  }
+
+  /*
+   * Confirm that an item obtained by next() was processed (after its
+   * successors were pushed)
+   */
+  void done()
+  {
+    if(--this->pending == 0)
+      this->wake(true);
+  }
+
+  /*
+   * Stop the work (e.g., if some worker failed)
+   */
+  void stop()
+  {
+    this->stopped = true;
+    this->wake(true);
+  }
+};
+
+#endif
@@ -755,12 +755,38 @@ void BuchiAutomaton<State, Symbol>::restriction(set<State>& st)
   std::set_intersection(this->initials.begin(),this->initials.end(),st.begin(),
     st.end(), std::inserter(newini, newini.begin()));
   this->trans = newtrans;
+  this->transCSR.clear();
   this->states = st;
   this->finals = newfin;
   this->initials = newini;
 }
 
 
+/*
+ * Freeze the current transitions into the CSR layout with forward and
+ * backward index (assumes nonnegative states and symbols, preferably
+ * numbered from 0 with no gaps).
+ */
+template <>
+void BuchiAutomaton<int, int>::freezeTransitions()
+{
+  int stCnt = 0;
+  int symCnt = 0;
+  if(!this->states.empty())
+    stCnt = *this->states.rbegin() + 1;
+  if(!this->alph.empty())
+    symCnt = *this->alph.rbegin() + 1;
+  for(const auto& t : this->trans)
+  {
+    stCnt = std::max(stCnt, t.first.first + 1);
+    symCnt = std::max(symCnt, t.first.second + 1);
+    if(!t.second.empty())
+      stCnt = std::max(stCnt, *t.second.rbegin() + 1);
+  }
+  this->transCSR.build(this->trans, stCnt, symCnt);
+}
+
+
 /*
  * Complete  the automaton (in place modification)
  * @param trap New (possibly) trap state
@@ -794,6 +820,7 @@ void BuchiAutomaton<State, Symbol>::complete(State trap, bool fin)
   }
   if(modif)
   {
+    this->transCSR.clear();
     for(Symbol s : this->alph)
     {
       auto pr = std::make_pair(trap, s);
@@ -866,44 +893,63 @@ vector<set<int> > BuchiAutomaton<int, int>::reachableVector()
 
 
 /*
- * Compute the odd rank simulation (stores in this->oddRankSim)
- * @param cl Closure of states
+ * Get the engine computing the odd rank simulation (states are indexed in
+ * ascending order)
+ * @param inv Out parameter for the states corresponding to indices
+ * @return Rank simulation engine
  */
 template <typename State, typename Symbol>
-void BuchiAutomaton<State, Symbol>::computeRankSim(std::set<State>& cl)
+RankSimulation BuchiAutomaton<State, Symbol>::getRankSimulation(vector<State>& inv)
 {
-  StateRelation rel = this->directSim;
-  bool add = false;
-  std::map<Symbol, bool> ignore;
-
-  for(Symbol s : this->alph)
+  inv = vector<State>(this->states.begin(), this->states.end());
+  std::map<State, int> ind;
+  for(const State& st : inv)
+    ind.insert(ind.end(), {st, (int)ind.size()});
+  std::map<Symbol, int> symInd;
+  for(const Symbol& sym : this->alph)
+    symInd.insert(symInd.end(), {sym, (int)symInd.size()});
+
+  vector<vector<vector<int>>> succ(symInd.size(), vector<vector<int>>(inv.size()));
+  for(const auto& t : this->trans)
   {
-    ignore[s] = false;
-    for(State st : cl)
-    {
-      if(this->trans[{st, s}].size() == 0)
-        ignore[s] = true;
-    }
-
+    auto its = symInd.find(t.first.second);
+    if(its == symInd.end())
+      continue;
+    vector<int>& dst = succ[its->second][ind[t.first.first]];
+    for(const State& d : t.second)
+      dst.push_back(ind[d]);
   }
+  set<int> fin;
+  for(const State& st : this->finals)
+    fin.insert(ind[st]);
+  return RankSimulation(inv.size(), fin, succ);
+}
 
-  do {
-    add = false;
-    transitiveClosure(rel, cl);
-    for(State st1 : this->states)
-    {
-      if(this->finals.find(st1) != this->finals.end())
-        continue;
-      for(State st2 : this->states)
-      {
-        if(this->finals.find(st2) != this->finals.end())
-          continue;
-        bool der = deriveRankConstr(st1, st2, rel);
-        if(der)
-          add = true;
-      }
-    }
-  } while(add);
+
+/*
+ * Compute the odd rank simulation (stores in this->oddRankSim)
+ * @param cl Closure of states
+ */
+template <typename State, typename Symbol>
+void BuchiAutomaton<State, Symbol>::computeRankSim(std::set<State>& cl)
+{
+  vector<State> inv;
+  RankSimulation rs = this->getRankSimulation(inv);
+  std::map<State, int> ind;
+  for(const State& st : inv)
+    ind.insert(ind.end(), {st, (int)ind.size()});
+
+  set<int> clInd;
+  for(const State& st : cl)
+    clInd.insert(ind[st]);
+  BitRelation seed(inv.size());
+  for(const auto& pr : this->directSim)
+    seed.insert(ind[pr.first], ind[pr.second]);
+
+  StateRelation rel;
+  rs.compute(seed, clInd).forEach([&rel, &inv](int i, int j) {
+    rel.insert(rel.end(), {inv[i], inv[j]});
+  });
   this->oddRankSim = rel;
 }
 
@@ -927,76 +973,6 @@ bool BuchiAutomaton<State, Symbol>::containsRankSimEq(std::set<State>& cl)
 }
 
 
-/*
- * Function computing transitive closure of give relation
- * @param rel Relation (out parameter)
- * @param cl Closure of states (for computation of odd rank simulation)
- */
-template <typename State, typename Symbol>
-void BuchiAutomaton<State, Symbol>::transitiveClosure(
-    BuchiAutomaton<State, Symbol>::StateRelation& rel, std::set<State>& cl)
-{
-  unsigned s = rel.size();
-  do
-  {
-    s = rel.size();
-    for(auto p1 : rel)
-    {
-      if(cl.find(p1.first) == cl.end() || cl.find(p1.second) == cl.end())
-        continue;
-      for(auto p2 : rel)
-      {
-        if(cl.find(p2.first) == cl.end() || cl.find(p2.second) == cl.end())
-          continue;
-        if(p1.second == p2.first)
-          rel.insert({p1.first, p2.second});
-      }
-    }
-  } while(s != rel.size());
-}
-
-
-/*
- * Get constraints for two states wrt odd rank simulation
- * @param st1 First state
- * @param st2 Second state
- * @param rel odd rank simulation
- */
-template <typename State, typename Symbol>
-bool BuchiAutomaton<State, Symbol>::deriveRankConstr(State& st1, State& st2,
-    BuchiAutomaton<State, Symbol>::StateRelation& rel)
-{
-  bool leq = true;
-  bool geq = true;
-  bool ret = false;
-  //bool fwdlq = false;
-  //bool fwdgq = false;
-  StateRelation nw;
-
-  for(Symbol sym : this->alph)
-  {
-    set<State> dst1 = this->trans[{st1, sym}];
-    set<State> dst2 = this->trans[{st2, sym}];
-    if(!isRankLeq(dst1, dst2, rel) /*&& !ignore[sym]*/)
-      leq = false;
-    if(!isRankLeq(dst2, dst1, rel) /*&& !ignore[sym]*/)
-      geq = false;
-    //propagateFwd(st1, st2, dst1, dst2, rel, nw);
-  }
-
-  if(leq) nw.insert({st1, st2});
-  if(geq) nw.insert({st2, st1});
-
-  for(auto it : nw)
-  {
-    if(rel.find(it) == rel.end())
-      ret = true;
-    rel.insert(it);
-  }
-  return ret;
-}
-
-
 /*
  * Propagate odd rank sim values to successor states (obsolete)
  */
@@ -1020,84 +996,130 @@ void BuchiAutomaton<State, Symbol>::propagateFwd(State& st1, State& st2,
 
 
 /*
- * Are all states of set1 bigger than all states of set2?
- * @param set1 First set of states
- * @param set2 Second set of states
- * @param rel Rank simulation (or relation in general)
- * @return set1 >=(forall, forall) sett2
- */
-template <typename State, typename Symbol>
-bool BuchiAutomaton<State, Symbol>::isRankLeq(std::set<State>& set1, std::set<State>& set2,
-    BuchiAutomaton<State, Symbol>::StateRelation& rel)
-{
-  for(State st1 : set1)
-  {
-    if(this->finals.find(st1) != this->finals.end())
-      continue;
-    for(State st2 : set2)
-    {
-      if(this->finals.find(st2) != this->finals.end())
-        continue;
-      if(rel.find({st1, st2}) == rel.end())
-        return false;
-    }
-  }
-  return true;
-}
-
-
-/*
- * Implementation of a simple data flow analysis. The values are iteratively
- * propagated through graph of the automaton.
+ * Implementation of a simple data flow analysis. The values are propagated
+ * through the graph of the automaton: SCCs are processed in the reverse
+ * topological order and inside an SCC the values are updated using a worklist
+ * until a fixpoint is reached (the update function is assumed to be monotone).
  * @param updFnc Function updating values of the states
  * @param initFnc Function assigning initial values to states
  * @return Values assigned to each state after fixpoint
  */
 template <typename State, typename Symbol>
 std::map<State, int> BuchiAutomaton<State, Symbol>::propagateGraphValues(
-    const std::function<int(LabelState<State>*,VecLabelStatesPtr)>& updFnc, const std::function<int(const State&)>& initFnc)
+    const std::function<int(LabelState<State>*,const VecLabelStatesPtr&)>& updFnc, const std::function<int(const State&)>& initFnc)
 {
-  std::map<State, LabelState<State>*> lst;
-  VecLabelStatesPtr active;
-  std::map<State, std::vector<LabelState<State>*>> tr;
-  for(State st : this->states)
+  std::map<State, int> id;
+  VecLabelStates labels;
+  labels.reserve(this->states.size());
+  for(const State& st : this->states)
   {
-    LabelState<State>* nst = new LabelState<State>;
-    nst->label = initFnc(st);
-    nst->state = st;
-
-    active.push_back(nst);
-    lst[st] = nst;
-    tr[st] = std::vector<LabelState<State>*>();
+    id.insert({st, labels.size()});
+    labels.push_back({ st, initFnc(st) });
   }
 
-  for(auto t : this->trans)
+  int n = labels.size();
+  std::vector<VecLabelStatesPtr> succ(n);
+  std::vector<std::vector<int>> adj(n);
+  std::vector<std::vector<int>> pred(n);
+  for(const auto& t : this->trans)
   {
-    for(auto d : t.second)
+    auto src = id.find(t.first.first);
+    if(src == id.end())
+      continue;
+    for(const State& d : t.second)
     {
-      tr[t.first.first].push_back(lst[d]);
+      auto dst = id.find(d);
+      if(dst == id.end())
+        continue;
+      succ[src->second].push_back(&labels[dst->second]);
+      adj[src->second].push_back(dst->second);
+      pred[dst->second].push_back(src->second);
     }
   }
 
-  bool change = false;
-  do {
-    change = false;
-    for(LabelState<State>* ls : active)
+  // iterative Tarjan's algorithm; SCCs are completed in the reverse
+  // topological order (successor SCCs first)
+  std::vector<int> index(n, -1);
+  std::vector<int> lowLink(n, 0);
+  std::vector<int> comp(n, -1);
+  std::vector<bool> onStack(n, false);
+  std::vector<int> tarjan;
+  std::vector<std::pair<int, size_t>> dfs;
+  std::vector<int> worklist;
+  std::vector<bool> queued(n, false);
+  int counter = 0;
+  int comps = 0;
+
+  for(int root = 0; root < n; root++)
+  {
+    if(index[root] != -1)
+      continue;
+    dfs.push_back({root, 0});
+    while(!dfs.empty())
     {
-      int nval = updFnc(ls, tr[ls->state]);
-      if(nval != ls->label)
-        change = true;
-      ls->label = nval;
-    }
-  } while(change);
+      int v = dfs.back().first;
+      size_t& it = dfs.back().second;
+      if(it == 0 && index[v] == -1)
+      {
+        index[v] = lowLink[v] = counter++;
+        tarjan.push_back(v);
+        onStack[v] = true;
+      }
+      if(it < adj[v].size())
+      {
+        int w = adj[v][it++];
+        if(index[w] == -1)
+          dfs.push_back({w, 0});
+        else if(onStack[w])
+          lowLink[v] = std::min(lowLink[v], index[w]);
+        continue;
+      }
 
-  map<State, int> activeVal;
-  for(unsigned i = 0; i < active.size(); i++)
-  {
-    activeVal[active[i]->state] = active[i]->label;
-    delete active[i];
+      dfs.pop_back();
+      if(!dfs.empty())
+      {
+        int u = dfs.back().first;
+        lowLink[u] = std::min(lowLink[u], lowLink[v]);
+      }
+      if(lowLink[v] != index[v])
+        continue;
+
+      // the SCC of v is complete; all successor SCCs are already stable
+      int w;
+      do {
+        w = tarjan.back();
+        tarjan.pop_back();
+        onStack[w] = false;
+        comp[w] = comps;
+        worklist.push_back(w);
+        queued[w] = true;
+      } while(w != v);
+
+      while(!worklist.empty())
+      {
+        int u = worklist.back();
+        worklist.pop_back();
+        queued[u] = false;
+        int nval = updFnc(&labels[u], succ[u]);
+        if(nval == labels[u].label)
+          continue;
+        labels[u].label = nval;
+        for(int p : pred[u])
+        {
+          if(comp[p] == comps && !queued[p])
+          {
+            worklist.push_back(p);
+            queued[p] = true;
+          }
+        }
+      }
+      comps++;
+    }
   }
 
+  std::map<State, int> activeVal;
+  for(const LabelState<State>& ls : labels)
+    activeVal.insert(activeVal.end(), { ls.state, ls.label });
   return activeVal;
 }
 
@@ -1111,12 +1133,10 @@ template <typename State, typename Symbol>
 std::vector<Symbol> BuchiAutomaton<State, Symbol>::containsSelfLoop(State& state)
 {
   vector<Symbol> ret;
-  auto trans = this->getTransitions();
   for(const auto& a : this->getAlphabet())
   {
-    set<State> dst = trans[std::make_pair(state, a)];
-    auto it = dst.find(state);
-    if(it != dst.end())
+    auto it = this->trans.find(std::make_pair(state, a));
+    if(it != this->trans.end() && it->second.find(state) != it->second.end())
       ret.push_back(a);
   }
   return ret;
@@ -1225,12 +1245,13 @@ set<State> BuchiAutomaton<State, Symbol>::getEventReachable(set<State>& sls)
 
 
 /*
- * Get states closing a cycle in the automaton graph
+ * Get states closing a cycle in the automaton graph (restricted search
+ * for every edge into an already visited state).
  * @params slignore States containing self-loops to be ignored
  * @return Set of states closing a cycle
  */
 template <typename State, typename Symbol>
-set<State> BuchiAutomaton<State, Symbol>::getCycleClosingStates(set<State>& slignore)
+set<State> BuchiAutomaton<State, Symbol>::getCycleClosingStatesSearch(set<State>& slignore)
 {
   set<State> ret;
   std::stack<State> stack;
@@ -1267,6 +1288,169 @@ set<State> BuchiAutomaton<State, Symbol>::getCycleClosingStates(set<State>& slig
 }
 
 
+/*
+ * Get states closing a cycle in the automaton graph. A single DFS from the
+ * initial states computes the SCCs (Tarjan's algorithm) and collects targets
+ * of back edges, which form a feedback vertex set of the reachable part.
+ * Redundant states (not closing any cycle avoiding the other selected states
+ * of the same SCC) are then removed from this set and from the set of
+ * getCycleClosingStatesSearch; the smaller one is returned (the latter on a
+ * tie), so the result is never larger than the one of the restricted search.
+ * @params slignore States containing self-loops to be ignored
+ * @return Set of states closing a cycle
+ */
+template <typename State, typename Symbol>
+set<State> BuchiAutomaton<State, Symbol>::getCycleClosingStates(set<State>& slignore)
+{
+  std::map<State, int> id;
+  std::vector<State> vert;
+  vert.reserve(this->states.size());
+  for(const State& st : this->states)
+  {
+    id.insert(id.end(), {st, vert.size()});
+    vert.push_back(st);
+  }
+
+  int n = vert.size();
+  std::vector<std::vector<int>> adj(n);
+  for(const auto& t : this->trans)
+  {
+    auto src = id.find(t.first.first);
+    if(src == id.end())
+      continue;
+    bool ignore = slignore.find(t.first.first) != slignore.end();
+    for(const State& d : t.second)
+    {
+      auto dst = id.find(d);
+      if(dst == id.end() || (ignore && dst->second == src->second))
+        continue;
+      adj[src->second].push_back(dst->second);
+    }
+  }
+
+  std::vector<int> index(n, -1);
+  std::vector<int> lowLink(n, 0);
+  std::vector<int> comp(n, -1);
+  std::vector<bool> onPath(n, false);
+  std::vector<bool> onStack(n, false);
+  std::vector<bool> closing(n, false);
+  std::vector<int> tarjan;
+  std::vector<std::pair<int, size_t>> dfs;
+  int counter = 0;
+  int comps = 0;
+
+  for(const State& in : this->initials)
+  {
+    auto root = id.find(in);
+    if(root == id.end() || index[root->second] != -1)
+      continue;
+    dfs.push_back({root->second, 0});
+    while(!dfs.empty())
+    {
+      int v = dfs.back().first;
+      size_t& it = dfs.back().second;
+      if(it == 0 && index[v] == -1)
+      {
+        index[v] = lowLink[v] = counter++;
+        tarjan.push_back(v);
+        onStack[v] = onPath[v] = true;
+      }
+      if(it < adj[v].size())
+      {
+        // successors are explored in the reverse order (last symbol first)
+        int w = adj[v][adj[v].size() - 1 - it++];
+        if(index[w] == -1)
+        {
+          dfs.push_back({w, 0});
+          continue;
+        }
+        if(onPath[w])
+          closing[w] = true;
+        if(onStack[w])
+          lowLink[v] = std::min(lowLink[v], index[w]);
+        continue;
+      }
+
+      onPath[v] = false;
+      dfs.pop_back();
+      if(!dfs.empty())
+      {
+        int u = dfs.back().first;
+        lowLink[u] = std::min(lowLink[u], lowLink[v]);
+      }
+      if(lowLink[v] == index[v])
+      {
+        int w;
+        do {
+          w = tarjan.back();
+          tarjan.pop_back();
+          onStack[w] = false;
+          comp[w] = comps;
+        } while(w != v);
+        comps++;
+      }
+    }
+  }
+
+  // a selected state is redundant if it does not close a cycle avoiding the
+  // other selected states (the search is restricted to its SCC)
+  std::vector<int> mark(n, -1);
+  std::vector<int> stack;
+  auto reduce = [&](std::vector<bool>& sel) {
+    size_t size = 0;
+    for(int v = 0; v < n; v++)
+    {
+      if(!sel[v])
+        continue;
+      sel[v] = false;
+      bool cycle = false;
+      stack.assign(1, v);
+      mark[v] = v;
+      while(!stack.empty() && !cycle)
+      {
+        int u = stack.back();
+        stack.pop_back();
+        for(int w : adj[u])
+        {
+          if(w == v)
+          {
+            cycle = true;
+            break;
+          }
+          if(comp[w] == comp[v] && mark[w] != v && !sel[w])
+          {
+            mark[w] = v;
+            stack.push_back(w);
+          }
+        }
+      }
+      sel[v] = cycle;
+      size += cycle ? 1 : 0;
+    }
+    return size;
+  };
+
+  std::vector<bool> searched(n, false);
+  for(const State& st : this->getCycleClosingStatesSearch(slignore))
+  {
+    auto it = id.find(st);
+    if(it != id.end())
+      searched[it->second] = true;
+  }
+  size_t closingSize = reduce(closing);
+  if(reduce(searched) <= closingSize)
+    closing = searched;
+
+  set<State> ret;
+  for(int i = 0; i < n; i++)
+  {
+    if(closing[i])
+      ret.insert(ret.end(), vert[i]);
+  }
+  return ret;
+}
+
+
 template<typename State, typename Symbol>
 std::set<State> BuchiAutomaton<State, Symbol> :: getAllSuccessors(State state)
 {
@@ -1366,7 +1550,7 @@ BuchiAutomaton<tuple<State, int, bool>, Symbol> BuchiAutomaton<State, Symbol>::p
   stack<ProdState> stack;
   set<State> fin1 = this->getFinals();
   set<int> fin2 = other.getFinals();
-  auto tr1 = this->getTransitions();
+  auto tr1 = this->trans;
   auto tr2 = other.getTransitions();
   map<std::pair<ProdState, Symbol>, set<ProdState>> ntr;
   set<ProdState> nfin;
@@ -1446,7 +1630,7 @@ BuchiAutomaton<pair<State, int>, Symbol> BuchiAutomaton<State, Symbol>::cartProd
   stack<ProdState> stack;
   set<State> fin1 = this->getFinals();
   set<int> fin2 = other.getFinals();
-  auto tr1 = this->getTransitions();
+  auto tr1 = this->trans;
   auto tr2 = other.getTransitions();
   map<std::pair<ProdState, Symbol>, set<ProdState>> ntr;
   set<ProdState> nfin;
@@ -1505,7 +1689,7 @@ BuchiAutomaton<State, Symbol> BuchiAutomaton<State, Symbol>::unionBA(BuchiAutoma
 
   set<State> nstates;
   set<State> nini;
-  Transitions ntr(this->getTransitions());
+  Transitions ntr(this->trans);
   set<State> nfin;
 
   set_union(this->getStates().begin(), this->getStates().end(), other.getStates().begin(),
@@ -1527,7 +1711,7 @@ BuchiAutomaton<State, Symbol> BuchiAutomaton<State, Symbol>::unionBA(BuchiAutoma
 template <typename State, typename Symbol>
 void BuchiAutomaton<State, Symbol>::singleInitial(State init)
 {
-  auto& tr = this->getTransitions();
+  auto& tr = this->mutableTransitions();
   this->states.insert(init);
   for(const Symbol& s : this->getAlph())
   {
@@ -1552,7 +1736,7 @@ vector<set<State>> BuchiAutomaton<State, Symbol>::getRunTree(vector<Symbol>& wor
 {
   set<State> nstates;
   set<State> nini;
-  Transitions ntr = this->getTransitions();
+  Transitions ntr = this->trans;
   set<State> nfin;
   vector<set<State>> ret;
 
@@ -1587,7 +1771,7 @@ Delta<State, Symbol> BuchiAutomaton<State, Symbol>::getReverseTransitions()
     for(const Symbol& a : this->getAlphabet())
       prev[{s,a}] = set<State>();
   }
-  for(const auto& t : this->getTransitions())
+  for(const auto& t : this->trans)
   {
     for(const auto& d : t.second)
       prev[{d,t.first.second}].insert(t.first.first);
@@ -12,11 +12,14 @@
 #include <functional>
 #include <numeric>
 #include <chrono>
+#include <cassert>
 
 #include "AutGraph.h"
+#include "DeltaCSR.h"
 #include "../Complement/StateKV.h"
 #include "../Complement/StateSch.h"
 #include "../Algorithms/AuxFunctions.h"
+#include "../Algorithms/RankSimulation.h"
 #include "APSymbol.h"
 
 using std::tuple;
@@ -43,14 +46,44 @@ struct Stat
   // time
   std::chrono::time_point<std::chrono::high_resolution_clock> beginning;
   std::chrono::time_point<std::chrono::high_resolution_clock> end;
-  long waitingPart;
-  long rankBound;
+  long waitingPart = 0;
+  long rankBound = 0;
   long elevatorRank = -1;
-  long cycleClosingStates;
+  long cycleClosingStates = 0;
   long getAllCycles = -1;
   long statesToGenerate = -1;
-  long simulations;
-  long tightPart;
+  long simulations = 0;
+  long tightPart = 0;
+  long selfLoops = 0;
+  long reachSizes = 0;
+  // wall time of all preprocessing phases (the phases may run in parallel;
+  // -1 if not measured as a whole)
+  long preprocessing = -1;
+  // CPU time of the preprocessing phases (including their helper threads;
+  // -1 if not measured)
+  long waitingPartCpu = -1;
+  long selfLoopsCpu = -1;
+  long reachSizesCpu = -1;
+  long rankBoundCpu = -1;
+  long elevatorRankCpu = -1;
+  long cycleClosingStatesCpu = -1;
+  long simulationsCpu = -1;
+
+  // subsets of macrostates evaluated in the rank bound computation
+  size_t rankBoundSubsets = 0;
+  size_t rankBoundCached = 0;
+  // macrostates with rank bounds evaluated on demand
+  size_t rankBoundMacrostates = 0;
+
+  // successor cache of the tight part
+  size_t succCacheHits = 0;
+  size_t succCacheMisses = 0;
+  size_t succCacheEvictions = 0;
+  // tight macrostates merged with a macrostate with the same transitions
+  size_t mergedStates = 0;
+  // cycles enumerated by the delay optimization, SCCs exceeding the cycle budget
+  size_t delayCycles = 0;
+  size_t delayOverBudget = 0;
 };
 
 /*
@@ -111,6 +144,7 @@ private:
   SetStates initials;
   SetSymbols alph;
   Delta<State, Symbol> trans;
+  DeltaCSR transCSR;
   map<string, int> apsPattern;
 
   StateRelation directSim;
@@ -125,11 +159,8 @@ protected:
   std::string toGraphwizWith(std::function<std::string(State)>& stateStr,  std::function<std::string(Symbol)>& symStr);
   std::string toGffWith(std::function<std::string(State)>& stateStr,  std::function<std::string(Symbol)>& symStr);
 
-  bool isRankLeq(std::set<State>& set1, std::set<State>& set2, StateRelation& rel);
-  bool deriveRankConstr(State& st1, State& st2, StateRelation& rel);
   void propagateFwd(State& st1, State& st2, SetStates& set1, SetStates& set2,
     StateRelation& rel,StateRelation& nw);
-  void transitiveClosure(StateRelation& rel, SetStates& cl);
 
   bool isReachDeterministic(set<State>& start);
 
@@ -174,6 +205,7 @@ public:
     this->states = other.states;
     this->finals = other.finals;
     this->trans = other.trans;
+    this->transCSR = other.transCSR;
     this->initials = other.initials;
     this->alph = other.alph;
     this->directSim = other.directSim;
@@ -262,11 +294,42 @@ public:
    * Get automaton transitions.
    * @return Transitions: map<pair<State, Symbol>, Set<States>>
    */
-  Transitions& getTransitions()
+  const Transitions& getTransitions() const
   {
     return this->trans;
   }
 
+  /*
+   * Get automaton transitions for a modification (drops the CSR layout, the
+   * transitions have to be frozen again before using it).
+   * @return Transitions: map<pair<State, Symbol>, Set<States>>
+   */
+  Transitions& mutableTransitions()
+  {
+    this->transCSR.clear();
+    return this->trans;
+  }
+
+  /*
+   * Get frozen transitions in the CSR layout (built by freezeTransitions and
+   * dropped by every modification of the transitions).
+   * @return Forward and backward CSR index
+   */
+  const DeltaCSR& getTransitionsCSR() const
+  {
+    assert(this->isFrozen());
+    return this->transCSR;
+  }
+
+  /*
+   * Are the transitions frozen in the CSR layout
+   * @return True if the CSR index is available
+   */
+  bool isFrozen() const
+  {
+    return this->transCSR.isBuilt();
+  }
+
   /*
    * Get automaton alphabet.
    * @return Set of symbols
@@ -397,8 +460,10 @@ public:
   void completeAPComplement();
   void removeUseless();
   void restriction(set<State>& st);
+  void freezeTransitions();
 
   void computeRankSim(SetStates& cl);
+  RankSimulation getRankSimulation(vector<State>& inv);
   bool containsRankSimEq(SetStates& cl);
   vector<Symbol> containsSelfLoop(State& state);
 
@@ -408,10 +473,11 @@ public:
   set<State> getSelfLoops();
   set<State> getAllSuccessors(State state);
 
-  std::map<State, int> propagateGraphValues(const std::function<int(LabelState<State>*,VecLabelStatesPtr)>& updFnc,
+  std::map<State, int> propagateGraphValues(const std::function<int(LabelState<State>*,const VecLabelStatesPtr&)>& updFnc,
     const std::function<int(const State&)>& initFnc);
 
   SetStates getCycleClosingStates(SetStates& slignore);
+  SetStates getCycleClosingStatesSearch(SetStates& slignore);
   bool reachWithRestriction(const State& from, const State& to, SetStates& restr, SetStates& high);
 
   bool isEmpty();
@@ -0,0 +1,150 @@
+#ifndef _DELTA_CSR_H_
+#define _DELTA_CSR_H_
+
+#include <set>
+#include <map>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+/*
+ * Contiguous range of states (successors or predecessors)
+ */
+struct StateRange
+{
+  const int* first;
+  const int* last;
+
+  const int* begin() const { return first; }
+  const int* end() const { return last; }
+  size_t size() const { return last - first; }
+  bool empty() const { return first == last; }
+};
+
+/*
+ * Frozen transition function of an automaton over int states and int symbols
+ * in the compressed sparse row layout. Successors (predecessors) of a pair
+ * (state, symbol) are stored contiguously and in ascending order; the offsets
+ * are indexed by state*symbols + symbol.
+ */
+class DeltaCSR
+{
+private:
+  int stateCount;
+  int symbolCount;
+  std::vector<unsigned> succOffsets;
+  std::vector<int> succ;
+  std::vector<unsigned> predOffsets;
+  std::vector<int> pred;
+
+  /*
+   * Range of a given row in a given index
+   */
+  StateRange row(const std::vector<unsigned>& off, const std::vector<int>& val, int state, int symbol) const
+  {
+    if(state < 0 || state >= this->stateCount || symbol < 0 || symbol >= this->symbolCount)
+      return {nullptr, nullptr};
+    size_t ind = (size_t)state*this->symbolCount + symbol;
+    return {val.data() + off[ind], val.data() + off[ind+1]};
+  }
+
+public:
+  DeltaCSR() : stateCount(0), symbolCount(0), succOffsets(), succ(), predOffsets(), pred() { }
+
+  /*
+   * Build the forward and the backward index.
+   * @param trans Transition function (states and symbols are nonnegative)
+   * @param states Number of states (all states are smaller)
+   * @param symbols Number of symbols (all symbols are smaller)
+   */
+  void build(const std::map<std::pair<int, int>, std::set<int>>& trans, int states, int symbols)
+  {
+    size_t rows = (size_t)states*symbols;
+    this->stateCount = states;
+    this->symbolCount = symbols;
+    this->succOffsets.assign(rows + 1, 0);
+    this->predOffsets.assign(rows + 1, 0);
+
+    for(const auto& t : trans)
+    {
+      this->succOffsets[(size_t)t.first.first*symbols + t.first.second + 1] += t.second.size();
+      for(int d : t.second)
+        this->predOffsets[(size_t)d*symbols + t.first.second + 1]++;
+    }
+    for(size_t i = 0; i < rows; i++)
+    {
+      this->succOffsets[i+1] += this->succOffsets[i];
+      this->predOffsets[i+1] += this->predOffsets[i];
+    }
+
+    this->succ.resize(this->succOffsets[rows]);
+    this->pred.resize(this->predOffsets[rows]);
+    std::vector<unsigned> fill(this->predOffsets.begin(), this->predOffsets.end() - 1);
+    // map is ordered by (state, symbol), hence predecessors are filled in
+    // ascending order as well
+    for(const auto& t : trans)
+    {
+      size_t ind = (size_t)t.first.first*symbols + t.first.second;
+      std::copy(t.second.begin(), t.second.end(), this->succ.begin() + this->succOffsets[ind]);
+      for(int d : t.second)
+        this->pred[fill[(size_t)d*symbols + t.first.second]++] = t.first.first;
+    }
+  }
+
+  /*
+   * Drop both indices.
+   */
+  void clear()
+  {
+    this->stateCount = this->symbolCount = 0;
+    this->succOffsets.clear();
+    this->succ.clear();
+    this->predOffsets.clear();
+    this->pred.clear();
+  }
+
+  /*
+   * Is the index built
+   * @return True if build was called (and not cleared since)
+   */
+  bool isBuilt() const
+  {
+    return !this->succOffsets.empty();
+  }
+
+  /*
+   * Successors of a state over a symbol.
+   * @param state State
+   * @param symbol Symbol
+   * @return Range of successors (ascending)
+   */
+  StateRange successors(int state, int symbol) const
+  {
+    return row(this->succOffsets, this->succ, state, symbol);
+  }
+
+  /*
+   * Predecessors of a state over a symbol.
+   * @param state State
+   * @param symbol Symbol
+   * @return Range of predecessors (ascending)
+   */
+  StateRange predecessors(int state, int symbol) const
+  {
+    return row(this->predOffsets, this->pred, state, symbol);
+  }
+
+  /*
+   * Is there a transition state -symbol-> dest
+   */
+  bool hasTransition(int state, int symbol, int dest) const
+  {
+    StateRange rng = successors(state, symbol);
+    return std::binary_search(rng.begin(), rng.end(), dest);
+  }
+
+  int getStateCount() const { return this->stateCount; }
+  int getSymbolCount() const { return this->symbolCount; }
+};
+
+#endif
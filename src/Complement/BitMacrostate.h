@@ -0,0 +1,246 @@
+#ifndef _BIT_MACROSTATE_H_
+#define _BIT_MACROSTATE_H_
+
+#include <set>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "../Automata/DeltaCSR.h"
+
+/*
+ * Macrostate (set of states) represented as a bitset with a fixed number of
+ * 64-bit words (Words = 0 means the number of words is given at runtime).
+ */
+template <unsigned Words>
+struct BitMacrostate
+{
+  std::array<uint64_t, Words> bits;
+
+  BitMacrostate(size_t = Words) : bits() { }
+
+  size_t wordCount() const { return Words; }
+  uint64_t* data() { return bits.data(); }
+  const uint64_t* data() const { return bits.data(); }
+
+  bool operator==(const BitMacrostate<Words>& other) const
+  {
+    return bits == other.bits;
+  }
+};
+
+template <>
+struct BitMacrostate<0>
+{
+  std::vector<uint64_t> bits;
+
+  BitMacrostate(size_t words = 0) : bits(words, 0) { }
+
+  size_t wordCount() const { return bits.size(); }
+  uint64_t* data() { return bits.data(); }
+  const uint64_t* data() const { return bits.data(); }
+
+  bool operator==(const BitMacrostate<0>& other) const
+  {
+    return bits == other.bits;
+  }
+};
+
+namespace BitSet
+{
+  /*
+   * Insert a state into a macrostate
+   */
+  template <typename Macro>
+  inline void insert(Macro& m, int state)
+  {
+    m.data()[state >> 6] |= uint64_t(1) << (state & 63);
+  }
+
+  /*
+   * Is a state contained in a macrostate
+   */
+  template <typename Macro>
+  inline bool contains(const Macro& m, int state)
+  {
+    return (m.data()[state >> 6] >> (state & 63)) & 1;
+  }
+
+  /*
+   * Is the macrostate empty
+   */
+  template <typename Macro>
+  inline bool empty(const Macro& m)
+  {
+    for(size_t i = 0; i < m.wordCount(); i++)
+    {
+      if(m.data()[i] != 0)
+        return false;
+    }
+    return true;
+  }
+
+  /*
+   * Number of states in a macrostate
+   */
+  template <typename Macro>
+  inline unsigned count(const Macro& m)
+  {
+    unsigned ret = 0;
+    for(size_t i = 0; i < m.wordCount(); i++)
+      ret += __builtin_popcountll(m.data()[i]);
+    return ret;
+  }
+
+  /*
+   * Call a function for each state of a macrostate (in ascending order)
+   */
+  template <typename Macro, typename Fnc>
+  inline void forEach(const Macro& m, Fnc fnc)
+  {
+    for(size_t i = 0; i < m.wordCount(); i++)
+    {
+      uint64_t w = m.data()[i];
+      while(w != 0)
+      {
+        fnc(int(i*64 + __builtin_ctzll(w)));
+        w &= w - 1;
+      }
+    }
+  }
+
+  /*
+   * Convert a set of states to a macrostate
+   */
+  template <typename Macro>
+  inline Macro fromSet(const std::set<int>& st, size_t words)
+  {
+    Macro ret(words);
+    for(int s : st)
+      insert(ret, s);
+    return ret;
+  }
+
+  /*
+   * Convert a macrostate to a set of states
+   */
+  template <typename Macro>
+  inline std::set<int> toSet(const Macro& m)
+  {
+    std::set<int> ret;
+    forEach(m, [&ret](int s) { ret.insert(ret.end(), s); });
+    return ret;
+  }
+
+  /*
+   * Hash of a macrostate
+   */
+  template <typename Macro>
+  inline size_t hash(const Macro& m)
+  {
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for(size_t i = 0; i < m.wordCount(); i++)
+    {
+      h ^= m.data()[i] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+  }
+}
+
+/*
+ * Hash functor for macrostates
+ */
+template <typename Macro>
+struct BitMacrostateHash
+{
+  size_t operator()(const Macro& m) const { return BitSet::hash(m); }
+};
+
+/*
+ * Successor kernel of the subset construction. For automata with at most
+ * 256 states it keeps a precomputed successor mask for each pair (state,
+ * symbol), hence a post-image is an OR-reduction over the set bits. For larger
+ * automata the successors are taken from the CSR transitions.
+ */
+class SubsetKernel
+{
+private:
+  size_t words;
+  int symbols;
+  std::vector<uint64_t> masks;
+  DeltaCSR trans;
+
+public:
+  SubsetKernel() : words(0), symbols(0), masks(), trans() { }
+
+  /*
+   * Build the kernel for given transitions.
+   * @param csr Frozen transitions
+   */
+  void build(const DeltaCSR& csr)
+  {
+    this->symbols = csr.getSymbolCount();
+    this->words = (csr.getStateCount() + 63) / 64;
+    this->masks.clear();
+    this->trans.clear();
+    if(this->words > 4)
+    {
+      this->trans = csr;
+      return;
+    }
+
+    this->masks.assign((size_t)csr.getStateCount()*this->symbols*this->words, 0);
+    for(int st = 0; st < csr.getStateCount(); st++)
+    {
+      for(int sym = 0; sym < this->symbols; sym++)
+      {
+        uint64_t* row = this->masks.data() + ((size_t)st*this->symbols + sym)*this->words;
+        for(int d : csr.successors(st, sym))
+          row[d >> 6] |= uint64_t(1) << (d & 63);
+      }
+    }
+  }
+
+  /*
+   * Number of 64-bit words of a macrostate
+   */
+  size_t getWords() const
+  {
+    return this->words;
+  }
+
+  /*
+   * Post-image of a macrostate
+   * @param macro Macrostate
+   * @param symbol Symbol
+   * @param out Successor macrostate (overwritten)
+   */
+  template <typename Macro>
+  void post(const Macro& macro, int symbol, Macro& out) const
+  {
+    uint64_t* dst = out.data();
+    std::fill(dst, dst + out.wordCount(), 0);
+    if(symbol < 0 || symbol >= this->symbols)
+      return;
+
+    if(!this->masks.empty())
+    {
+      const uint64_t* base = this->masks.data();
+      BitSet::forEach(macro, [&](int st) {
+        const uint64_t* row = base + ((size_t)st*this->symbols + symbol)*this->words;
+        for(size_t i = 0; i < this->words; i++)
+          dst[i] |= row[i];
+      });
+    }
+    else
+    {
+      BitSet::forEach(macro, [&](int st) {
+        for(int d : this->trans.successors(st, symbol))
+          dst[d >> 6] |= uint64_t(1) << (d & 63);
+      });
+    }
+  }
+};
+
+#endif
@@ -1,6 +1,13 @@
 
 #include "BuchiAutomatonSpec.h"
 #include <chrono>
+#include <thread>
+#include <exception>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../Algorithms/WorkStealing.h"
+#include "../Algorithms/TaskGraph.h"
 
 /*
  * Set of all successors.
@@ -13,7 +20,7 @@ set<int> BuchiAutomatonSpec::succSet(set<int>& states, int symbol)
   set<int> ret;
   for(int st : states)
   {
-    set<int> dst = getTransitions()[std::make_pair(st, symbol)];
+    StateRange dst = this->getTransitionsCSR().successors(st, symbol);
     ret.insert(dst.begin(), dst.end());
   }
   return ret;
@@ -34,7 +41,7 @@ set<StateKV> BuchiAutomatonSpec::succSetKV(StateKV& state, int symbol)
   vector<int> maxRank(getStates().size(), 2*getStates().size());
   for(int st : state.S)
   {
-    set<int> dst = getTransitions()[std::make_pair(st, symbol)];
+    StateRange dst = this->getTransitionsCSR().successors(st, symbol);
     for(int d : dst)
     {
       maxRank[d] = std::min(maxRank[d], state.f[st]);
@@ -168,14 +175,11 @@ BuchiAutomaton<StateKV, int> BuchiAutomatonSpec::complementKV()
  * @param max Vector of maximal ranks (indexed by states)
  * @param states Set of states in a macrostate (the S-set)
  * @param macrostate Current macrostate
- * @param reachCons SuccRank restriction
  * @param reachMax Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param ctx Tight part context
  */
 void BuchiAutomatonSpec::getSchRanksTight(vector<RankFunc>& out, vector<int>& max,
-    set<int>& states, StateSch& macrostate,
-    map<int, int> reachCons, int reachMax, BackRel& dirRel, BackRel& oddRel)
+    set<int>& states, StateSch& macrostate, int reachMax, const TightContext& ctx)
 {
   RankConstr constr;
   map<int, int> sngmap;
@@ -200,10 +204,10 @@ void BuchiAutomatonSpec::getSchRanksTight(vector<RankFunc>& out, vector<int>& ma
     constr.push_back(singleConst);
   }
 
-  auto tmp = RankFunc::tightSuccFromRankConstr(constr, dirRel, oddRel, macrostate.f.getMaxRank(),
-    reachCons, reachMax, true);
+  bool succExists = RankFunc::existsTightSuccFromRankConstr(constr, ctx.oddRel, macrostate.f.getMaxRank(),
+    ctx.reachCons, reachMax);
   RankFunc sng(sngmap, true);
-  if(sng.isTightRank() && sng.getMaxRank() == macrostate.f.getMaxRank() && tmp.size() > 0)
+  if(sng.isTightRank() && sng.getMaxRank() == macrostate.f.getMaxRank() && succExists)
     out = vector<RankFunc>({sng});
   else
   {
@@ -215,21 +219,15 @@ void BuchiAutomatonSpec::getSchRanksTight(vector<RankFunc>& out, vector<int>& ma
 
 /*
  * Get starting states of the tight part
- * @param state DFA macrostate
- * @param rankBound Maximum rank
- * @param macrostate Current macrostate
- * @param reachCons SuccRank restriction
- * @param reachMax Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param macro Id of the DFA macrostate
+ * @param ctx Tight part context
  * @return Set of first states in the tight part
  */
-vector<StateSch> BuchiAutomatonSpec::succSetSchStart(set<int>& state, int rankBound,
-    map<int, int> reachCons, map<DFAState, int> maxReach, BackRel& dirRel,
-    BackRel& oddRel)
+vector<StateSch> BuchiAutomatonSpec::succSetSchStart(int macro, const TightContext& ctx)
 {
   vector<StateSch> ret;
-  set<int> sprime = state;
+  set<int> sprime = ctx.macros.get(macro);
+  int rankBound = ctx.macros.getRankBound(macro);
   set<int> schfinal;
   set<int> fin = getFinals();
   std::set_difference(sprime.begin(),sprime.end(),fin.begin(),
@@ -243,12 +241,10 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchStart(set<int>& state, int rankBo
       maxRank[st] -= 1;
   }
 
-  int reachMaxAct = maxReach[sprime];
+  int reachMaxAct = ctx.macros.getMaxReach(macro);
   RankConstr constr = rankConstr(maxRank, sprime);
-  for(const RankFunc& item : RankFunc::tightFromRankConstr(constr, dirRel, oddRel, reachCons, reachMaxAct, true))
-  {
-    ret.push_back({sprime, set<int>(), item, 0, true});
-  }
+  RankFunc::tightFromRankConstr(constr, ctx.dirRel, ctx.oddRel, ctx.reachCons, reachMaxAct, true,
+    [&](RankFunc& item) { ret.push_back({sprime, set<int>(), item, 0, true}); return true; });
   return ret;
 }
 
@@ -257,15 +253,17 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchStart(set<int>& state, int rankBo
  * Get all ranking functions (use cache memory)
  * @param out Out parameter to store tight ranks
  * @param state Schewe state (macrostate)
+ * @param macro Id of the S-set of the state
  * @param symbol Symbol
+ * @param cache Successor cache
  * @return Is successor found in cache?
  */
-bool BuchiAutomatonSpec::getRankSuccCache(vector<RankFunc>& out, StateSch& state, int symbol)
+bool BuchiAutomatonSpec::getRankSuccCache(vector<RankFunc>& out, StateSch& state, int macro, int symbol, SuccRankCache& cache)
 {
-  auto it = this->rankCache.find({state.S, symbol, state.f.getMaxRank()});
-  if(it == this->rankCache.end())
+  auto it = cache.find({macro, symbol, state.f.getMaxRank()});
+  if(it == cache.end())
   {
-    this->rankCache[{state.S, symbol, state.f.getMaxRank()}] = vector<std::pair<RankFunc, vector<RankFunc>>>();
+    cache[{macro, symbol, state.f.getMaxRank()}] = vector<std::pair<RankFunc, vector<RankFunc>>>();
   }
   else
   {
@@ -282,18 +280,56 @@ bool BuchiAutomatonSpec::getRankSuccCache(vector<RankFunc>& out, StateSch& state
 }
 
 
+/*
+ * Intern the macrostates of the waiting part together with their rank bounds
+ * (taken from this->rankBound) and maximum reachable sizes
+ * @param index Index to be built
+ * @param comp Waiting part
+ * @param maxReach Maximum reachable macrostate
+ */
+void BuchiAutomatonSpec::buildMacrostateIndex(MacrostateIndex& index, BuchiAutomaton<StateSch, int>& comp,
+    map<DFAState, int>& maxReach)
+{
+  int symbols = this->getAlphabet().empty() ? 0 : *this->getAlphabet().rbegin() + 1;
+  index.build(comp, this->getStates().size(), symbols);
+  for(size_t i = 0; i < index.size(); i++)
+  {
+    auto itb = this->rankBound.find(index.get(i));
+    if(itb != this->rankBound.end())
+      index.rankBound[i] = itb->second.bound;
+    auto itr = maxReach.find(index.get(i));
+    if(itr != maxReach.end())
+      index.maxReach[i] = itr->second;
+  }
+}
+
+
+/*
+ * Minimum reachable sizes as a vector indexed by states
+ * @param reachCons Minimum reachable size of each state
+ * @return Vector of the sizes (0 for states without a value)
+ */
+vector<int> BuchiAutomatonSpec::getReachConsVector(map<int, int>& reachCons)
+{
+  vector<int> ret(this->getStates().size(), 0);
+  for(const auto& pr : reachCons)
+  {
+    if(pr.first >= (int)ret.size())
+      ret.resize(pr.first + 1, 0);
+    ret[pr.first] = pr.second;
+  }
+  return ret;
+}
+
+
 /*
  * Get all Schewe successros
  * @param state Schewe state
  * @param symbol Symbol
- * @param reachCons SuccRank restriction
- * @param reachMax Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param ctx Tight part context
  * @return Set of all successors
  */
-vector<StateSch> BuchiAutomatonSpec::succSetSchTight(StateSch& state, int symbol,
-    map<int, int> reachCons, map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel)
+vector<StateSch> BuchiAutomatonSpec::succSetSchTight(StateSch& state, int symbol, const TightContext& ctx)
 {
   vector<StateSch> ret;
   set<int> sprime;
@@ -305,21 +341,21 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchTight(StateSch& state, int symbol
 
   for(int st : state.S)
   {
-    set<int> dst = getTransitions()[std::make_pair(st, symbol)];
+    StateRange dst = this->getTransitionsCSR().successors(st, symbol);
     for(int d : dst)
     {
       maxRank[d] = std::min(maxRank[d], state.f[st]);
     }
     sprime.insert(dst.begin(), dst.end());
     if(fin.find(st) == fin.end())
-      succ[st] = dst;
+      succ[st] = set<int>(dst.begin(), dst.end());
 
     // BEWARE
     // if(state.f.find(st)->second == 0)
     // {
     //   return ret;
     // }
-    if(state.f.find(st)->second == 0 && reachCons[st] > 0)
+    if(state.f.find(st)->second == 0 && ctx.reachCons[st] > 0)
     {
       return ret;
     }
@@ -329,7 +365,9 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchTight(StateSch& state, int symbol
     }
   }
 
-  if(this->rankBound[state.S].bound > state.f.getMaxRank() || this->rankBound[sprime].bound > state.f.getMaxRank())
+  int macro = ctx.macros.find(state.S);
+  int macroPrime = ctx.macros.post(macro, symbol);
+  if(ctx.macros.getRankBound(macro) > state.f.getMaxRank() || ctx.macros.getRankBound(macroPrime) > state.f.getMaxRank())
   {
     return ret;
   }
@@ -355,16 +393,15 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchTight(StateSch& state, int symbol
     oprime = succSet(state.O, symbol);
   }
 
-  int maxReachAct = maxReach[sprime];
+  int maxReachAct = ctx.macros.getMaxReach(macroPrime);
   vector<RankFunc> ranks;
   vector<RankFunc> tmp;
   set<int> inverseRank;
 
-  if(!getRankSuccCache(tmp, state, symbol))
+  if(!getRankSuccCache(tmp, state, macro, symbol, this->rankCache))
   {
-    getSchRanksTight(tmp, maxRank, sprime, state,
-        reachCons, maxReachAct, dirRel, oddRel);
-    this->rankCache[{state.S, symbol, state.f.getMaxRank()}].push_back({state.f, tmp});
+    getSchRanksTight(tmp, maxRank, sprime, state, maxReachAct, ctx);
+    this->rankCache[{macro, symbol, state.f.getMaxRank()}].push_back({state.f, tmp});
   }
 
   for (auto& r : tmp)
@@ -433,6 +470,9 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSch()
 
   // Compute rank upper bound on the macrostates
   this->rankBound = this->getRankBound(comp, slIgnore, maxReach, reachCons);
+  MacrostateIndex macros;
+  this->buildMacrostateIndex(macros, comp, maxReach);
+  vector<int> reachConsVec = this->getReachConsVector(reachCons);
   map<StateSch, DelayLabel> delayMp;
   for(const auto& st : comp.getStates())
   {
@@ -458,6 +498,7 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSch()
 
   BackRel dirRel = createBackRel(this->getDirectSim());
   BackRel oddRel = createBackRel(this->getOddRankSim());
+  TightContext ctx = { macros, reachConsVec, dirRel, oddRel, false };
 
   bool cnt = true;
 
@@ -475,12 +516,12 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSch()
       //set<StateSch> dst;
       if(st.tight)
       {
-        succ = succSetSchTight(st, sym, reachCons, maxReach, dirRel, oddRel);
+        succ = succSetSchTight(st, sym, ctx);
         //succ = set<StateSch>();
       }
       else
       {
-        succ = succSetSchStart(st.S, rankBound[st.S].bound, reachCons, maxReach, dirRel, oddRel);
+        succ = succSetSchStart(macros.find(st.S), ctx);
         cnt = false;
       }
       for (const StateSch& s : succ)
@@ -508,21 +549,21 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSch()
  * @param out Out parameter to store tight ranks
  * @param max Vector of maximal ranks (indexed by states)
  * @param states Set of states in a macrostate (the S-set)
+ * @param macro Id of the S-set of the current macrostate
+ * @param symbol Symbol
  * @param macrostate Current macrostate
- * @param reachCons SuccRank restriction
  * @param reachMax Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param ctx Tight part context
+ * @param cache Successor existence cache
  */
 void BuchiAutomatonSpec::getSchRanksTightReduced(vector<RankFunc>& out, vector<int>& max,
-    set<int>& states, int symbol, StateSch& macrostate,
-    map<int, int> reachCons, int reachMax, BackRel& dirRel, BackRel& oddRel)
+    set<int>& states, int macro, int symbol, StateSch& macrostate,
+    int reachMax, const TightContext& ctx, SuccExistCache& cache)
 {
   RankConstr constr;
   map<int, int> sngmap;
 
-  set<int> fin = getFinals();
-  vector<int> rnkBnd;
+  const set<int>& fin = this->getFinals();
   for(int st : states)
   {
     vector<std::pair<int, int> > singleConst;
@@ -540,34 +581,24 @@ void BuchiAutomatonSpec::getSchRanksTightReduced(vector<RankFunc>& out, vector<i
     sngmap[st] = max[st];
     singleConst.push_back(std::make_pair(st, max[st]));
     constr.push_back(singleConst);
-    rnkBnd.push_back(max[st]);
   }
 
-  vector<RankFunc> tmp;
-  int rankSetSize = 1;
-
+  // only small macrostates are checked: the check itself (not the memory of
+  // the cache) is the limiting cost on larger ones
+  bool succExists = true;
   if(this->opt.succEmptyCheck && macrostate.S.size() <= this->opt.CacheMaxState && macrostate.f.getMaxRank() <= this->opt.CacheMaxRank)
   {
-    if(!getRankSuccCache(tmp, macrostate, symbol))
-    {
-      tmp = RankFunc::tightSuccFromRankConstr(constr, dirRel, oddRel, macrostate.f.getMaxRank(),
-        reachCons, reachMax, this->opt.cutPoint);
-      this->rankCache[{macrostate.S, symbol, macrostate.f.getMaxRank()}].push_back({macrostate.f, tmp});
-      rankSetSize = tmp.size();
-    }
-    else
+    SuccExistCache::Key key(macro, symbol, macrostate.f.getMaxRank());
+    if(!cache.find(key, macrostate.f, succExists))
     {
-      rankSetSize = tmp.size();
-      for(auto& r : tmp)
-      {
-        if(!r.isMaxRankValid(rnkBnd))
-          rankSetSize--;
-      }
+      succExists = RankFunc::existsTightSuccFromRankConstr(constr, ctx.oddRel, macrostate.f.getMaxRank(),
+        ctx.reachCons, reachMax);
+      cache.insert(key, macrostate.f, succExists);
     }
   }
 
   RankFunc sng(sngmap, this->opt.cutPoint);
-  if(sng.isTightRank() && sng.getMaxRank() == macrostate.f.getMaxRank() && rankSetSize > 0)
+  if(sng.isTightRank() && sng.getMaxRank() == macrostate.f.getMaxRank() && succExists)
     out = vector<RankFunc>({sng});
   else
   {
@@ -580,120 +611,164 @@ void BuchiAutomatonSpec::getSchRanksTightReduced(vector<RankFunc>& out, vector<i
  * Get all Schewe successros (optimized version)
  * @param state Schewe state
  * @param symbol Symbol
- * @param reachCons SuccRank restriction
- * @param reachMax Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param ctx Tight part context
+ * @param cache Successor existence cache
  * @return Set of all successors
  */
 vector<StateSch> BuchiAutomatonSpec::succSetSchTightReduced(StateSch& state, int symbol,
-    map<int, int> reachCons, map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel, bool eta4)
+    const TightContext& ctx, SuccExistCache& cache)
 {
-  vector<StateSch> ret;
-  set<int> sprime;
-  set<int> oprime;
-  int iprime;
-  vector<int> maxRank(getStates().size(), state.f.getMaxRank());
-  map<int, set<int> > succ;
-  map<int, bool > pre;
-  auto fin = getFinals();
+  TightScratch scratch;
+  vector<vector<StateSch>> out;
+  this->succSetSchTightReducedAll(state, vector<int>({symbol}), ctx, cache, scratch, out);
+  return out[0];
+}
 
+
+/*
+ * Get all Schewe successors over all symbols (optimized version). The data
+ * shared by all symbols (the S-set id, the rank bound check, ranks of the
+ * states, the next i for an empty O-set) are computed once; the vector of
+ * maximal ranks is kept in the scratch buffers and only its touched entries
+ * are reset.
+ * @param state Schewe state
+ * @param alph Symbols
+ * @param ctx Tight part context
+ * @param cache Successor existence cache
+ * @param scratch Reusable buffers (e.g., one per worker)
+ * @param out Out parameter: sets of all successors (in the order of alph)
+ */
+void BuchiAutomatonSpec::succSetSchTightReducedAll(StateSch& state, const vector<int>& alph,
+    const TightContext& ctx, SuccExistCache& cache, TightScratch& scratch, vector<vector<StateSch>>& out)
+{
+  out.assign(alph.size(), vector<StateSch>());
+  const set<int>& fin = this->getFinals();
+  int maxRankAct = state.f.getMaxRank();
+
+  int macro = ctx.macros.find(state.S);
+  if(ctx.macros.getRankBound(macro)*2-1 < maxRankAct)
+    return;
+
+  vector<int>& maxRank = scratch.maxRank;
+  if(maxRank.size() < this->getStates().size())
+    maxRank.assign(this->getStates().size(), -1);
+  vector<std::pair<int, int>> ranks;
   for(int st : state.S)
+    ranks.push_back({st, state.f[st]});
+  int iprimeEmpty = (state.i + 2) % (maxRankAct + 1);
+
+  for(size_t k = 0; k < alph.size(); k++)
   {
-    set<int> dst = getTransitions()[std::make_pair(st, symbol)];
-    for(int d : dst)
+    int symbol = alph[k];
+    set<int> sprime;
+    for(const auto& pr : ranks)
     {
-      maxRank[d] = std::min(maxRank[d], state.f[st]);
+      StateRange dst = this->getTransitionsCSR().successors(pr.first, symbol);
+      for(int d : dst)
+      {
+        if(maxRank[d] == -1 || pr.second < maxRank[d])
+          maxRank[d] = std::min(maxRankAct, pr.second);
+      }
+      sprime.insert(dst.begin(), dst.end());
     }
-    sprime.insert(dst.begin(), dst.end());
-    if(fin.find(st) == fin.end())
-      succ[st] = dst;
 
-  }
-
-  if(this->rankBound[state.S].bound*2-1 < state.f.getMaxRank() || this->rankBound[sprime].bound*2-1 < state.f.getMaxRank())
-  {
-    return ret;
-  }
-
-  vector<int> rnkBnd;
-  for(int i : sprime)
-  {
-    rnkBnd.push_back(maxRank[i]);
-  }
-
-  for(int st : sprime)
-  {
-    if(fin.find(st) != fin.end() && maxRank[st] % 2 != 0)
-      maxRank[st] -= 1;
-  }
-  if(state.O.size() == 0)
-  {
-    iprime = (state.i + 2) % (state.f.getMaxRank() + 1);
-  }
-  else
-  {
-    iprime = state.i;
-    oprime = succSet(state.O, symbol);
-  }
-
-  int maxReachAct = maxReach[sprime];
-  set<int> inverseRank;
-  vector<RankFunc> maxRanks;
-
-  getSchRanksTightReduced(maxRanks, maxRank, sprime, symbol, state,
-      reachCons, maxReachAct, dirRel, oddRel);
+    int macroPrime = ctx.macros.post(macro, symbol);
+    if(ctx.macros.getRankBound(macroPrime)*2-1 < maxRankAct)
+    {
+      for(int st : sprime)
+        maxRank[st] = -1;
+      continue;
+    }
 
-  for (auto& r : maxRanks)
-  {
-    set<int> oprime_tmp;
-    if(this->opt.cutPoint)
+    for(int st : sprime)
     {
-      inverseRank = r.inverseRank(iprime);
-      if (state.O.size() == 0)
-        oprime_tmp = inverseRank;
-      else
-        std::set_intersection(oprime.begin(),oprime.end(),inverseRank.begin(),
-          inverseRank.end(), std::inserter(oprime_tmp, oprime_tmp.begin()));
+      if(fin.find(st) != fin.end() && maxRank[st] % 2 != 0)
+        maxRank[st] -= 1;
+    }
+    int iprime;
+    set<int> oprime;
+    if(state.O.size() == 0)
+    {
+      iprime = iprimeEmpty;
     }
     else
     {
-      auto odd = r.getOddStates();
-      if (state.O.size() == 0)
+      iprime = state.i;
+      oprime = succSet(state.O, symbol);
+    }
+
+    int maxReachAct = ctx.macros.getMaxReach(macroPrime);
+    set<int> inverseRank;
+    vector<RankFunc> maxRanks;
+
+    getSchRanksTightReduced(maxRanks, maxRank, sprime, macro, symbol, state,
+        maxReachAct, ctx, cache);
+    for(int st : sprime)
+      maxRank[st] = -1;
+
+    vector<StateSch> ret;
+    for (auto& r : maxRanks)
+    {
+      set<int> oprime_tmp;
+      if(this->opt.cutPoint)
       {
-        std::set_difference(sprime.begin(), sprime.end(), odd.begin(), odd.end(),
-          std::inserter(oprime_tmp, oprime_tmp.begin()));
+        inverseRank = r.inverseRank(iprime);
+        if (state.O.size() == 0)
+          oprime_tmp = inverseRank;
+        else
+          std::set_intersection(oprime.begin(),oprime.end(),inverseRank.begin(),
+            inverseRank.end(), std::inserter(oprime_tmp, oprime_tmp.begin()));
       }
       else
       {
-        std::set_difference(oprime.begin(), oprime.end(), odd.begin(), odd.end(),
-          std::inserter(oprime_tmp, oprime_tmp.begin()));
+        auto odd = r.getOddStates();
+        if (state.O.size() == 0)
+        {
+          std::set_difference(sprime.begin(), sprime.end(), odd.begin(), odd.end(),
+            std::inserter(oprime_tmp, oprime_tmp.begin()));
+        }
+        else
+        {
+          std::set_difference(oprime.begin(), oprime.end(), odd.begin(), odd.end(),
+            std::inserter(oprime_tmp, oprime_tmp.begin()));
+        }
+        iprime = 0;
       }
-      iprime = 0;
+      ret.push_back({sprime, oprime_tmp, r, iprime, true});
     }
-    ret.push_back({sprime, oprime_tmp, r, iprime, true});
-  }
 
-  set<StateSch> retAll;
-  for(const StateSch& st : ret)
-  {
-    retAll.insert(st);
-    map<int, int> rnkMap((map<int, int>)st.f);
+    // successors of eta4 are generated only from S-sets with accepting states
+    bool sprimeAcc = std::any_of(sprime.begin(), sprime.end(), [&fin](int st) { return fin.find(st) != fin.end(); });
+    set<StateSch> retAll;
+    for(const StateSch& st : ret)
+    {
+      retAll.insert(st);
+      map<int, int> rnkMap((map<int, int>)st.f);
 
-    if (eta4){
-      SCC intersection;
-      std::set_intersection(st.S.begin(), st.S.end(), fin.begin(), fin.end(), std::inserter(intersection, intersection.begin()));
-      if (intersection.size() == 0)
+      if (ctx.eta4 && !sprimeAcc)
         continue;
-    }
 
-    if(state.O.size() == 0)
-      continue;
-    if(this->opt.cutPoint)
-    {
-      set<int> no;
-      if(st.i != 0 || st.O.size() == 0)
+      if(state.O.size() == 0)
+        continue;
+      if(this->opt.cutPoint)
       {
+        set<int> no;
+        if(st.i != 0 || st.O.size() == 0)
+        {
+          for(int o : st.O)
+          {
+            if(rnkMap[o] > 0 && fin.find(o) == fin.end())
+              rnkMap[o]--;
+            else
+              no.insert(o);
+          }
+          retAll.insert({st.S, no, RankFunc(rnkMap, this->opt.cutPoint), st.i, true});
+        }
+      }
+      else
+      {
+        set<int> no;
+        //bool cnt = true;
         for(int o : st.O)
         {
           if(rnkMap[o] > 0 && fin.find(o) == fin.end())
@@ -701,46 +776,28 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchTightReduced(StateSch& state, int
           else
             no.insert(o);
         }
+        // if(!cnt)
+        //   continue;
         retAll.insert({st.S, no, RankFunc(rnkMap, this->opt.cutPoint), st.i, true});
       }
     }
-    else
-    {
-      set<int> no;
-      //bool cnt = true;
-      for(int o : st.O)
-      {
-        if(rnkMap[o] > 0 && fin.find(o) == fin.end())
-          rnkMap[o]--;
-        else
-          no.insert(o);
-      }
-      // if(!cnt)
-      //   continue;
-      retAll.insert({st.S, no, RankFunc(rnkMap, this->opt.cutPoint), st.i, true});
-    }
+    out[k] = vector<StateSch>(retAll.begin(), retAll.end());
   }
-
-  return vector<StateSch>(retAll.begin(), retAll.end());
 }
 
 
 /*
  * Get starting states of the tight part (optimized version)
- * @param state DFA macrostate
- * @param rankBound Maximum rank
- * @param reachCons SuccRank restriction
- * @param maxReach Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param macro Id of the DFA macrostate
+ * @param ctx Tight part context
  * @return Set of first states in the tight part (optimized version)
  */
-vector<StateSch> BuchiAutomatonSpec::succSetSchStartReduced(set<int>& state, int rankBound,
-    map<int, int> reachCons, map<DFAState, int> maxReach, BackRel& dirRel,
-    BackRel& oddRel)
+vector<StateSch> BuchiAutomatonSpec::succSetSchStartReduced(int macro, const TightContext& ctx)
 {
   vector<StateSch> ret;
+  const set<int>& state = ctx.macros.get(macro);
   set<int> sprime = state;
+  int rankBound = ctx.macros.getRankBound(macro);
   set<int> schfinal;
   set<int> fin = getFinals();
   std::set_difference(sprime.begin(),sprime.end(),fin.begin(),
@@ -758,32 +815,16 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchStartReduced(set<int>& state, int
 
   if(state.size() >= this->opt.ROMinState && m >= this->opt.ROMinRank)
   {
-    maxRanks = RankFunc::getRORanks(rankBound, state, fin, this->opt.cutPoint);
+    maxRanks = RankFunc::getRORanks(rankBound, sprime, fin, this->opt.cutPoint);
   }
   else
   {
-    int reachMaxAct = maxReach[sprime];
+    int reachMaxAct = ctx.macros.getMaxReach(macro);
     RankConstr constr = rankConstr(maxRank, sprime);
-    auto tmp = RankFunc::tightFromRankConstr(constr, dirRel, oddRel, reachCons, reachMaxAct, this->opt.cutPoint);
-
-    set<RankFunc> tmpSet(tmp.begin(), tmp.end());
-
-    bool cnt = true;
-    for(auto& r : tmp)
-    {
-      cnt = true;
-      auto it = tmpSet.upper_bound(r);
-      while(it != tmpSet.end())
-      {
-        if(r != (*it) && r.getMaxRank() == it->getMaxRank() && r.isAllLeq(*it))
-        {
-          cnt = false;
-          break;
-        }
-        it = std::next(it, 1);
-      }
-      if(cnt) maxRanks.push_back(r);
-    }
+    RankAntichain antichain;
+    RankFunc::tightFromRankConstr(constr, ctx.dirRel, ctx.oddRel, ctx.reachCons, reachMaxAct, this->opt.cutPoint,
+      [&antichain](RankFunc& r) { antichain.insert(r); return true; });
+    maxRanks = antichain.getMaximal();
   }
 
   for(const RankFunc& item : maxRanks)
@@ -800,214 +841,619 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchStartReduced(set<int>& state, int
  */
 BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchReduced(bool delay, std::set<int> originalFinals, double w, delayVersion version, bool elevatorRank, bool eta4, Stat *stats)
 {
-  std::stack<StateSch> stack;
-  set<StateSch> comst;
-  set<StateSch> initials;
-  set<StateSch> finals;
-  vector<StateSch> succ;
-  set<int> alph = getAlphabet();
-  map<std::pair<StateSch, int>, set<StateSch> > mp;
-  map<std::pair<StateSch, int>, vector<StateSch> > mpVect;
-  map<std::pair<StateSch, int>, set<StateSch> >::iterator it;
-
-  // NFA part of the Schewe construction
-  auto start = std::chrono::high_resolution_clock::now();
-  BuchiAutomaton<StateSch, int> comp = this->complementSchNFA(this->getInitials());
-  auto end = std::chrono::high_resolution_clock::now();
-  stats->waitingPart = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+  BuchiAutomaton<int, int> ids = this->complementSchReducedIds(delay, originalFinals, w, version, elevatorRank, eta4, stats);
+  std::map<int, StateSch> labels = this->getComplementLabels();
+  BuchiAutomaton<StateSch, int> ret = ids.getComplStructure(labels);
+  ret.setAlphabet(ids.getAlphabet());
+  ret.setAPPattern(ids.getAPPattern());
+  return ret;
+}
 
-  // rank bound
-  start = std::chrono::high_resolution_clock::now();
 
-  map<std::pair<StateSch, int>, set<StateSch>> prev = comp.getReverseTransitions();
-  //std::cout << comp.toGraphwiz() << std::endl;
+/*
+ * Preprocessing of the optimized Schewe complementation (waiting part,
+ * self-loop states, reachability restrictions, rank bounds, starting states
+ * of the tight part and simulations). The results are stored in this->prep.
+ * The phases form a task graph run by opt.threads threads (independent
+ * phases run concurrently); wall and CPU time of each phase are stored in
+ * stats.
+ */
+void BuchiAutomatonSpec::prepareSchReduced(bool delay, std::set<int> originalFinals, double w, delayVersion version, bool elevatorRank, bool eta4, Stat *stats)
+{
+  SchReducedPrep& prep = this->prep;
+  prep.delay = delay;
+  prep.eta4 = eta4;
+  BuchiAutomaton<StateSch, int>& comp = prep.comp;
+  auto start = std::chrono::high_resolution_clock::now();
 
-  set<StateSch> slIgnore = this->nfaSlAccept(comp);
-  set<pair<DFAState,int>> slNonEmpty = this->nfaSingleSlNoAccept(comp);
+  set<StateSch> slIgnore;
+  set<pair<DFAState,int>> slNonEmpty;
   set<StateSch> ignoreAll;
-  for(const auto& t : slNonEmpty)
-    ignoreAll.insert({t.first, set<int>(), RankFunc(), 0, false});
-  ignoreAll.insert(slIgnore.begin(), slIgnore.end());
-  set<StateSch> nfaStates = comp.getStates();
-  comst.insert(nfaStates.begin(), nfaStates.end());
+  map<int, int> reachCons;
+  map<DFAState, int> maxReach;
+  TaskGraph tasks;
 
-  // Compute reachability restrictions
-  map<int, int> reachCons = this->getMinReachSize();
-  map<DFAState, int> maxReach = this->getMaxReachSize(comp, slIgnore);
-
-  mp.insert(comp.getTransitions().begin(), comp.getTransitions().end());
-  finals = set<StateSch>(comp.getFinals());
+  // NFA part of the Schewe construction
+  int waitingTask = tasks.add([&]() {
+    prep.comp = this->complementSchNFA(this->getInitials());
+    prep.prev = comp.getReverseTransitions();
+    //std::cout << comp.toGraphwiz() << std::endl;
+  });
+
+  // self-loop states
+  int slTask = tasks.add([&]() {
+    slIgnore = this->nfaSlAccept(comp);
+    slNonEmpty = this->nfaSingleSlNoAccept(comp);
+    for(const auto& t : slNonEmpty)
+      ignoreAll.insert({t.first, set<int>(), RankFunc(), 0, false});
+    ignoreAll.insert(slIgnore.begin(), slIgnore.end());
+
+    int newState = this->getStates().size(); //Assumes numbered states: from 0, no gaps
+    prep.slStates.clear();
+    prep.slSymbols.clear();
+    for(const auto& pr : slNonEmpty)
+    {
+      prep.slStates[pr] = newState;
+      prep.slSymbols[newState] = pr.second;
+      newState++;
+    }
+  }, { waitingTask });
+
+  // Compute reachability restrictions (the minimum reachable sizes do not
+  // depend on the waiting part)
+  int reachTask = tasks.add([&]() {
+    reachCons = this->getMinReachSize();
+    prep.reachCons = this->getReachConsVector(reachCons);
+  });
+  int maxReachTask = tasks.add([&]() {
+    maxReach = this->getMaxReachSize(comp, slIgnore);
+  }, { slTask });
+
+  // Compute rank upper bound on the macrostates. The delay optimization and
+  // the elevator rank need bounds of all macrostates; otherwise the bounds
+  // are evaluated on demand by the tight part (only for the macrostates
+  // reachable from its starting states).
+  bool lazyBound = !delay && !elevatorRank;
+  int boundTask = tasks.add([&]() {
+    if (!lazyBound)
+      this->rankBound = this->getRankBound(comp, ignoreAll, maxReach, reachCons, stats);
+  }, { maxReachTask, reachTask });
+
+  // simulations (on the original automaton)
+  int simTask = tasks.add([&]() {
+    set<int> cl;
+    this->computeRankSim(cl);
+
+    prep.dirRel = createBackRel(this->getDirectSim());
+    prep.oddRel = createBackRel(this->getOddRankSim());
+  });
+
+  // update rank upper bound of each macrostate based on elevator automaton
+  // structure (the SCCs are computed on a renamed copy of the automaton,
+  // which reads the simulations and writes the rename maps)
+  int elevatorTask = -1;
+  if (elevatorRank){
+    elevatorTask = tasks.add([&]() {
+      this->elevatorRank(comp);
+    }, { boundTask, simTask });
+  }
+  int boundDone = elevatorRank ? elevatorTask : boundTask;
+  tasks.add([&]() {
+    this->buildMacrostateIndex(prep.macros, comp, maxReach);
+    if (lazyBound){
+      prep.macros.setRankBoundEval([this, ignoreAll, maxReach, reachCons, stats](int macro) mutable {
+        this->evalRankBoundRegion(macro, ignoreAll, maxReach, reachCons, stats);
+      });
+    }
+  }, { boundDone });
+
+  // states necessary to generate in the tight part (rank bounds are needed
+  // only by the delay optimization)
+  vector<int> closingDeps = { slTask };
+  if (delay)
+    closingDeps.push_back(boundDone);
+  int closingTask = tasks.add([&]() {
+    prep.tightStart.clear();
+    prep.tightStartDelay.clear();
+    if (delay){
+      map<StateSch, DelayLabel> delayMp;
+      for(const auto& st : comp.getStates())
+      {
+        delayMp[st] = {
+          .macrostateSize = (unsigned)st.S.size(),
+          .maxRank = (unsigned)this->rankBound.at(st.S).bound
+        };
+
+        // nonaccepting states
+        std::set<int> result;
+        std::set_difference(st.S.begin(), st.S.end(), originalFinals.begin(), originalFinals.end(), std::inserter(result, result.end()));
+        delayMp[st].nonAccStates = result.size();
+      }
+      BuchiAutomatonDelay<int> delayB(comp);
+      prep.tightStartDelay = delayB.getCycleClosingStates(ignoreAll, delayMp, w, version, stats, this->opt.delayCycleBudget);
+      for(const auto& item : prep.tightStartDelay)
+        prep.tightStart.insert(item.first);
+    }
+    else {
+      prep.tightStart = comp.getCycleClosingStates(ignoreAll);
+    }
+  }, closingDeps);
 
-  int newState = this->getStates().size(); //Assumes numbered states: from 0, no gaps
-  map<pair<DFAState,int>, StateSch> slTrans;
-  for(const auto& pr : slNonEmpty)
-  {
-    //std::cout << StateSch::printSet(pr.first) << std::endl;
-    StateSch ns = { set<int>({newState}), set<int>(), RankFunc(), 0, false };
-    StateSch src = { pr.first, set<int>(), RankFunc(), 0, false };
-    slTrans[pr] = ns;
-    mp[{ns,pr.second}] = set<StateSch>({ns});
-    mp[{src, pr.second}].insert(ns);
-    finals.insert(ns);
-    comst.insert(ns);
-    newState++;
+  tasks.run(std::max(1u, this->opt.threads));
+  auto end = std::chrono::high_resolution_clock::now();
+  stats->preprocessing = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+
+  stats->waitingPart = tasks.getTiming(waitingTask).wall;
+  stats->waitingPartCpu = tasks.getTiming(waitingTask).cpu;
+  stats->selfLoops = tasks.getTiming(slTask).wall;
+  stats->selfLoopsCpu = tasks.getTiming(slTask).cpu;
+  stats->reachSizes = tasks.getTiming(reachTask).wall + tasks.getTiming(maxReachTask).wall;
+  stats->reachSizesCpu = tasks.getTiming(reachTask).cpu + tasks.getTiming(maxReachTask).cpu;
+  stats->rankBound = tasks.getTiming(boundTask).wall;
+  stats->rankBoundCpu = tasks.getTiming(boundTask).cpu;
+  if (elevatorRank){
+    stats->elevatorRank = tasks.getTiming(elevatorTask).wall;
+    stats->elevatorRankCpu = tasks.getTiming(elevatorTask).cpu;
   }
+  stats->cycleClosingStates = tasks.getTiming(closingTask).wall;
+  stats->cycleClosingStatesCpu = tasks.getTiming(closingTask).cpu;
+  stats->simulations = tasks.getTiming(simTask).wall;
+  stats->simulationsCpu = tasks.getTiming(simTask).cpu;
+}
 
 
-  // Compute rank upper bound on the macrostates
-  this->rankBound = this->getRankBound(comp, ignoreAll, maxReach, reachCons);
-  end = std::chrono::high_resolution_clock::now();
-  stats->rankBound = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+/*
+ * Optimized Schewe complementation procedure with states numbered by dense
+ * ids (states of the waiting part first, then tight states ordered by their
+ * encoding). Macrostates corresponding to the ids are available via
+ * getComplementLabels. The tight part is explored by opt.threads workers.
+ * @return Complemented automaton
+ */
+BuchiAutomaton<int, int> BuchiAutomatonSpec::complementSchReducedIds(bool delay, std::set<int> originalFinals, double w, delayVersion version, bool elevatorRank, bool eta4, Stat *stats)
+{
+  set<int> finals;
+  set<int> alph = getAlphabet();
+  vector<std::tuple<int, int, int>> mp;
+  unsigned workers = std::max(1u, this->opt.threads);
+  // macrostates of the waiting part are inserted sequentially (their order
+  // is kept in seeds), tight macrostates are inserted by the workers
+  ShardedStateStore visited(workers > 1 ? 64*workers : 1);
+  vector<int> seeds;
+
+  this->prepareSchReduced(delay, originalFinals, w, version, elevatorRank, eta4, stats);
+  BuchiAutomaton<StateSch, int>& comp = this->prep.comp;
+  const map<std::pair<StateSch, int>, set<StateSch>>& prev = this->prep.prev;
+  const map<StateSch, set<int>>& tightStartDelay = this->prep.tightStartDelay;
+  TightContext ctx = { this->prep.macros, this->prep.reachCons, this->prep.dirRel, this->prep.oddRel, eta4 };
+
+  // macrostates are stored packed; the original states and the states of the
+  // self-loops are numbered from 0 with no gaps
+  this->complCodec = StateSchCodec(this->getStates().size() + this->prep.slStates.size(), this->opt.cutPoint);
+  StateSchCodec& codec = this->complCodec;
+  auto insertSeed = [&](const StateSch& st) {
+    auto ins = visited.insert(codec.encode(st));
+    if(ins.second)
+      seeds.push_back(ins.first);
+    return ins.first;
+  };
+  for(const StateSch& st : comp.getStates())
+    insertSeed(st);
 
-  // update rank upper bound of each macrostate based on elevator automaton structure
-  if (elevatorRank){
-    start = std::chrono::high_resolution_clock::now();
-    this->elevatorRank(comp);
-    end = std::chrono::high_resolution_clock::now();;
-    stats->elevatorRank = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+  for(const auto& tr : comp.getTransitions())
+  {
+    int src = visited.find(codec.encode(tr.first.first));
+    for(const StateSch& d : tr.second)
+      mp.push_back({src, tr.first.second, visited.find(codec.encode(d))});
   }
+  for(const StateSch& st : comp.getFinals())
+    finals.insert(visited.find(codec.encode(st)));
 
-  // states necessary to generate in the tight part
-  start = std::chrono::high_resolution_clock::now();
-  map<StateSch, DelayLabel> delayMp;
-  for(const auto& st : comp.getStates())
+  map<pair<DFAState,int>, int> slTrans;
+  for(const auto& pr : this->prep.slStates)
   {
-    delayMp[st] = {
-      .macrostateSize = (unsigned)st.S.size(),
-      .maxRank = (unsigned)this->rankBound[st.S].bound
-    };
-
-    // nonaccepting states
-    std::set<int> result;
-    std::set_difference(st.S.begin(), st.S.end(), originalFinals.begin(), originalFinals.end(), std::inserter(result, result.end()));
-    delayMp[st].nonAccStates = result.size();
-  }
-  // Compute states necessary to generate in the tight part
-  set<StateSch> tightStart;
-  map<StateSch, set<int>> tightStartDelay;
-  if (delay){
-    BuchiAutomatonDelay<int> delayB(comp);
-    tightStartDelay = delayB.getCycleClosingStates(ignoreAll, delayMp, w, version, stats);
+    StateSch ns = { set<int>({pr.second}), set<int>(), RankFunc(), 0, false };
+    StateSch src = { pr.first.first, set<int>(), RankFunc(), 0, false };
+    int pns = insertSeed(ns);
+    slTrans[pr.first] = pns;
+    mp.push_back({pns, pr.first.second, pns});
+    mp.push_back({visited.find(codec.encode(src)), pr.first.second, pns});
+    finals.insert(pns);
   }
-  else {
-    tightStart = comp.getCycleClosingStates(ignoreAll);
-  }
-  end = std::chrono::high_resolution_clock::now();
-  stats->cycleClosingStates = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
 
-  std::set<StateSch> tmpSet;
-  if (delay){
-    for(auto item : tightStartDelay)
-      tmpSet.insert(item.first);
-  }
-  //std::set<StateSch> tmpStackSet;
-  for(const StateSch& tmp : (delay ? tmpSet : tightStart))
+  vector<int> alphVec(alph.begin(), alph.end());
+  WorkStealingQueues<std::pair<int, PackedStateSch>> queues(workers);
+  unsigned nextWorker = 0;
+  for(const StateSch& tmp : this->prep.tightStart)
   {
     if(tmp.S.size() > 0)
     {
-      stack.push(tmp);
+      PackedStateSch ptmp = codec.encode(tmp);
+      int id = visited.find(ptmp);
+      queues.push(nextWorker, {id, ptmp});
+      nextWorker = (nextWorker + 1) % workers;
     }
-    //tmpStackSet.insert(tmp);
   }
 
   StateSch init = {getInitials(), set<int>(), RankFunc(), 0, false};
-  initials.insert(init);
+  int initId = visited.find(codec.encode(init));
 
-  // simulations
-  start = std::chrono::high_resolution_clock::now();
-  set<int> cl;
-  this->computeRankSim(cl);
-
-  BackRel dirRel = createBackRel(this->getDirectSim());
-  BackRel oddRel = createBackRel(this->getOddRankSim());
-  end = std::chrono::high_resolution_clock::now();
-  stats->simulations = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
-
-  bool cnt = true;
-  unsigned transitionsToTight = 0;
-
-  // tight part construction
-  start = std::chrono::high_resolution_clock::now();
-  while(stack.size() > 0)
-  {
-    StateSch st = stack.top();
-    stack.pop();
-    if(isSchFinal(st))
-      finals.insert(st);
-    cnt = true;
+  // tight part construction; every worker has its own successor cache and
+  // collects its own transitions and final states. The shared data (rank
+  // bounds, reachability restrictions, predecessors) are only read.
+  auto start = std::chrono::high_resolution_clock::now();
+  vector<SuccExistCache> caches(workers, SuccExistCache(this->opt.CacheMaxBytes / workers));
+  vector<vector<std::tuple<int, int, int>>> workerTrans(workers);
+  vector<vector<int>> workerFinals(workers);
+  vector<TightScratch> scratches(workers);
+  auto explore = [&](unsigned wid) {
+    std::pair<int, PackedStateSch> item;
+    vector<std::tuple<int, int, int>>& trans = workerTrans[wid];
+    vector<StateSch> succ;
+    vector<vector<StateSch>> succAll;
+    bool cnt = true;
 
-    for(int sym : alph)
+    while(queues.next(wid, item))
     {
-      auto pr = std::make_pair(st, sym);
-      set<StateSch> dst;
+      int pst = item.first;
+      StateSch st = codec.decode(item.second);
+      if(isSchFinal(st))
+        workerFinals[wid].push_back(pst);
+      cnt = true;
+
+      // successors of a tight macrostate over all symbols at once
       if(st.tight)
+        succSetSchTightReducedAll(st, alphVec, ctx, caches[wid], scratches[wid], succAll);
+
+      for(size_t k = 0; k < alphVec.size(); k++)
       {
-        succ = succSetSchTightReduced(st, sym, reachCons, maxReach, dirRel, oddRel, eta4);
-      }
-      else
-      {
-        succ = succSetSchStartReduced(st.S, rankBound[st.S].bound, reachCons, maxReach, dirRel, oddRel);
-        //cout << st.toString() << " : " << succ.size() << endl;
-        cnt = false;
-        //auto tmp = succSetSchStart(st.S, rankBound[st.S], reachCons, maxReach, dirRel, oddRel);
-        //std::cerr << "Size: " << tmp.size() << std::endl;
-        //std::cerr << "Rank bound: " << rankBound[st.S] << std::endl;
-      }
-      for (const StateSch& s : succ)
-      {
-        dst.insert(s);
-        if(comst.find(s) == comst.end())
+        int sym = alphVec[k];
+        vector<int> dst;
+        if(st.tight)
         {
-          stack.push(s);
-          comst.insert(s);
+          succ = std::move(succAll[k]);
+        }
+        else
+        {
+          succ = succSetSchStartReduced(ctx.macros.find(st.S), ctx);
+          cnt = false;
+        }
+        for (StateSch& s : succ)
+        {
+          PackedStateSch ps = codec.encode(s);
+          auto ins = visited.insert(ps);
+          dst.push_back(ins.first);
+          if(ins.second)
+            queues.push(wid, {ins.first, ps});
         }
-      }
 
-      auto it = slTrans.find({st.S, sym});
-      if(it != slTrans.end())
-      {
-        dst.insert(it->second);
-      }
-      if(!st.tight)
-      {
-        if(!cnt)
+        auto it = slTrans.find({st.S, sym});
+        if(it != slTrans.end())
         {
-            for(const auto& a : this->getAlphabet())
+          dst.push_back(it->second);
+        }
+        if(!st.tight)
+        {
+          if(!cnt)
+          {
+            for(const auto& a : alph)
             {
-              for(const auto& d : prev[{st, a}]) {
-                if ((not delay) or tightStartDelay[d].find(a) != tightStartDelay[d].end()){
-                  mp[{d,a}].insert(dst.begin(), dst.end());
-                  transitionsToTight += dst.size();
+              auto itp = prev.find({st, a});
+              if(itp == prev.end())
+                continue;
+              for(const auto& d : itp->second) {
+                auto itd = tightStartDelay.find(d);
+                if ((not delay) or (itd != tightStartDelay.end() && itd->second.find(a) != itd->second.end())){
+                  int pd = visited.find(codec.encode(d));
+                  for(int t : dst)
+                    trans.push_back({pd, a, t});
                 }
               }
             }
-        }
-        else
-        {
-          if (not delay)
-            mp[pr].insert(dst.begin(), dst.end());
-          else {
-            if (tightStartDelay[st].find(sym) != tightStartDelay[st].end()){
-                mp[pr].insert(dst.begin(), dst.end());
+          }
+          else
+          {
+            auto itd = tightStartDelay.find(st);
+            if ((not delay) or (itd != tightStartDelay.end() && itd->second.find(sym) != itd->second.end()))
+            {
+              for(int t : dst)
+                trans.push_back({pst, sym, t});
             }
           }
         }
+        else{
+          for(int t : dst)
+            trans.push_back({pst, sym, t});
+        }
+        if(!cnt) break;
       }
-      else{
-        mp[pr] = dst;
+      queues.done();
+    }
+  };
+
+  if(workers == 1)
+  {
+    explore(0);
+  }
+  else
+  {
+    // an exception (e.g., bad_alloc) stops all workers and is rethrown
+    vector<std::exception_ptr> errors(workers);
+    vector<std::thread> pool;
+    for(unsigned i = 0; i < workers; i++)
+    {
+      pool.push_back(std::thread([&, i]() {
+        try
+        {
+          explore(i);
+        }
+        catch(...)
+        {
+          errors[i] = std::current_exception();
+          queues.stop();
+        }
+      }));
+    }
+    for(std::thread& t : pool)
+      t.join();
+    for(const std::exception_ptr& e : errors)
+    {
+      if(e)
+        std::rethrow_exception(e);
+    }
+  }
+
+  auto end = std::chrono::high_resolution_clock::now();
+  stats->tightPart = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+  for(const SuccExistCache& c : caches)
+  {
+    stats->succCacheHits += c.hits;
+    stats->succCacheMisses += c.misses;
+    stats->succCacheEvictions += c.evictions;
+  }
+  // deterministic numbering (independent of the number of workers): the
+  // macrostates of the waiting part in the order of insertion followed by
+  // the tight macrostates ordered by their encoding
+  vector<std::pair<const PackedStateSch*, int>> tight;
+  int maxId = 0;
+  visited.forEach([&](int id, const PackedStateSch& pst) {
+    maxId = std::max(maxId, id);
+    if(pst.isTight())
+      tight.push_back({&pst, id});
+  });
+  std::sort(tight.begin(), tight.end(), [](const std::pair<const PackedStateSch*, int>& a,
+    const std::pair<const PackedStateSch*, int>& b) { return *a.first < *b.first; });
+
+  // quotient of the tight part: tight macrostates with the same acceptance
+  // and the same transitions (a self-loop counts as a transition to the
+  // macrostate itself) are bisimilar and are merged into the first of them
+  // in the order of the encoding, so the result does not depend on the order
+  // in which the workers explored the macrostates
+  vector<int> merged(maxId + 1, -1);
+  if(this->opt.mergeTight)
+  {
+    vector<vector<std::pair<int, int>>> rows(maxId + 1);
+    for(const auto& trans : workerTrans)
+    {
+      for(const auto& tr : trans)
+      {
+        int src = std::get<0>(tr);
+        int dst = std::get<2>(tr);
+        rows[src].push_back({std::get<1>(tr), dst == src ? -1 : dst});
       }
-      if(!cnt) break;
     }
-    //std::cout << comst.size() << " : " << stack.size() << std::endl;
+    vector<bool> accepting(maxId + 1, false);
+    for(const auto& fins : workerFinals)
+    {
+      for(int f : fins)
+        accepting[f] = true;
+    }
+    map<std::pair<bool, vector<std::pair<int, int>>>, int> classes;
+    for(const auto& pr : tight)
+    {
+      vector<std::pair<int, int>>& row = rows[pr.second];
+      std::sort(row.begin(), row.end());
+      row.erase(std::unique(row.begin(), row.end()), row.end());
+      auto ins = classes.insert({{accepting[pr.second], std::move(row)}, pr.second});
+      if(!ins.second)
+      {
+        merged[pr.second] = ins.first->second;
+        stats->mergedStates++;
+      }
+    }
+  }
+
+  vector<int> renum(maxId + 1, -1);
+  PackedStateStore& comst = this->complStore;
+  comst.clear();
+  int cnt = 0;
+  for(int id : seeds)
+    renum[id] = cnt++;
+  for(const auto& pr : tight)
+  {
+    if(merged[pr.second] == -1)
+      renum[pr.second] = cnt++;
+  }
+  for(const auto& pr : tight)
+  {
+    if(merged[pr.second] != -1)
+      renum[pr.second] = renum[merged[pr.second]];
+  }
+  vector<const PackedStateSch*> byId(cnt, nullptr);
+  visited.forEach([&](int id, const PackedStateSch& pst) {
+    if(merged[id] == -1)
+      byId[renum[id]] = &pst;
+  });
+  for(const PackedStateSch* pst : byId)
+    comst.insert(*pst);
+
+  for(auto& tr : mp)
+    tr = std::make_tuple(renum[std::get<0>(tr)], std::get<1>(tr), renum[std::get<2>(tr)]);
+  for(const auto& trans : workerTrans)
+  {
+    for(const auto& tr : trans)
+    {
+      if(merged[std::get<0>(tr)] == -1)
+        mp.push_back({renum[std::get<0>(tr)], std::get<1>(tr), renum[std::get<2>(tr)]});
+    }
+  }
+  set<int> rfinals;
+  for(int f : finals)
+    rfinals.insert(renum[f]);
+  for(const auto& fins : workerFinals)
+  {
+    for(int f : fins)
+    {
+      if(merged[f] == -1)
+        rfinals.insert(renum[f]);
+    }
+  }
+
+  // emit the transitions over ids
+  std::sort(mp.begin(), mp.end());
+  mp.erase(std::unique(mp.begin(), mp.end()), mp.end());
+  set<int> rstates;
+  for(size_t i = 0; i < comst.size(); i++)
+    rstates.insert(rstates.end(), i);
+  Delta<int, int> rtrans;
+  for(const auto& tr : mp)
+  {
+    set<int>& dst = rtrans[{std::get<0>(tr), std::get<1>(tr)}];
+    dst.insert(dst.end(), std::get<2>(tr));
   }
 
-  //std::cerr << "Transitions to tight: " << transitionsToTight << std::endl;
+  return BuchiAutomaton<int, int>(rstates, rfinals,
+    set<int>({renum[initId]}), rtrans, alph, getAPPattern());
+}
 
-  end = std::chrono::high_resolution_clock::now();
-  stats->tightPart = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+/*
+ * Successors of a state of the optimized Schewe construction generated on
+ * demand (prepareSchReduced has to be called before). The transitions are the
+ * same as in the automaton built by complementSchReducedIds.
+ * @param state State of the complement
+ * @param symbol Symbol
+ * @param cache Successor existence cache
+ * @return Successors (may contain duplicates)
+ */
+vector<StateSch> BuchiAutomatonSpec::succSetSchReduced(StateSch& state, int symbol, SuccExistCache& cache)
+{
+  SchReducedPrep& prep = this->prep;
+  TightContext ctx = { prep.macros, prep.reachCons, prep.dirRel, prep.oddRel, prep.eta4 };
+  vector<StateSch> ret;
+  int states = this->getStates().size();
+  auto addSl = [&](const DFAState& S, int sym) {
+    auto it = prep.slStates.find({S, sym});
+    if(it != prep.slStates.end())
+      ret.push_back({set<int>({it->second}), set<int>(), RankFunc(), 0, false});
+  };
 
-  return BuchiAutomaton<StateSch, int>(comst, finals,
-    initials, mp, alph, getAPPattern());
+  if(state.tight)
+  {
+    ret = succSetSchTightReduced(state, symbol, ctx, cache);
+    addSl(state.S, symbol);
+    return ret;
+  }
+  // self-loop state
+  if(state.S.size() == 1 && *state.S.begin() >= states)
+  {
+    auto it = prep.slSymbols.find(*state.S.begin());
+    if(it != prep.slSymbols.end() && it->second == symbol)
+      ret.push_back(state);
+    return ret;
+  }
+
+  addSl(state.S, symbol);
+  auto it = prep.comp.getTransitions().find({state, symbol});
+  if(it == prep.comp.getTransitions().end())
+    return ret;
+  auto itd = prep.tightStartDelay.find(state);
+  bool toTight = (not prep.delay) || (itd != prep.tightStartDelay.end() && itd->second.find(symbol) != itd->second.end());
+  for(const StateSch& d : it->second)
+  {
+    ret.push_back(d);
+    if(!toTight || d.S.size() == 0 || prep.tightStart.find(d) == prep.tightStart.end())
+      continue;
+    vector<StateSch> start = succSetSchStartReduced(prep.macros.find(d.S), ctx);
+    ret.insert(ret.end(), start.begin(), start.end());
+    // complementSchReducedIds connects also the self-loop state of the
+    // starting macrostate over the first symbol
+    addSl(d.S, *this->getAlphabet().begin());
+  }
+  return ret;
+}
+
+
+/*
+ * Initial state of the complement (on-the-fly interface; prepareSchReduced
+ * has to be called before)
+ * @return Initial state
+ */
+StateSch BuchiAutomatonSpec::initial()
+{
+  return {this->getInitials(), set<int>(), RankFunc(), 0, false};
+}
+
+
+/*
+ * Successors of a state of the complement generated on demand (on-the-fly
+ * interface; prepareSchReduced has to be called before). Tight successors
+ * are cached in the successor cache of the automaton.
+ * @param state State of the complement
+ * @param symbol Symbol
+ * @return Successors (without duplicates)
+ */
+vector<StateSch> BuchiAutomatonSpec::successors(StateSch& state, int symbol)
+{
+  vector<StateSch> succ = this->succSetSchReduced(state, symbol, this->existCache);
+  set<StateSch> ret(succ.begin(), succ.end());
+  return vector<StateSch>(ret.begin(), ret.end());
+}
+
+
+/*
+ * Is a state of the complement accepting (on-the-fly interface)
+ * @param state State of the complement
+ * @return Is accepting
+ */
+bool BuchiAutomatonSpec::isAccepting(StateSch& state)
+{
+  // states accepting the self-loops are numbered after the original states
+  if(!state.tight && state.S.size() == 1 && *state.S.begin() >= (int)this->getStates().size())
+    return true;
+  return isSchFinal(state);
+}
+
+
+/*
+ * Codec of the states of the complement (on-the-fly interface)
+ * @return Codec for all states of the complement
+ */
+StateSchCodec BuchiAutomatonSpec::getImplicitCodec()
+{
+  return StateSchCodec(this->getStates().size() + this->prep.slStates.size(), this->opt.cutPoint);
+}
+
+/*
+ * Get macrostates of the last complement built by complementSchReducedIds
+ * @return Mapping of ids to macrostates
+ */
+std::map<int, StateSch> BuchiAutomatonSpec::getComplementLabels()
+{
+  std::map<int, StateSch> ret;
+  for(size_t i = 0; i < this->complStore.size(); i++)
+    ret.insert(ret.end(), {i, this->complCodec.decode(this->complStore.get(i))});
+  return ret;
+}
+
+
+/*
+ * Is the state of the last complement built by complementSchReducedIds in
+ * the tight part
+ * @param id Id of the state
+ * @return Is the macrostate tight
+ */
+bool BuchiAutomatonSpec::isComplementTight(int id) const
+{
+  return this->complStore.get(id).isTight();
 }
 
 
@@ -1017,46 +1463,95 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchReduced(bool dela
  */
 BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchNFA(set<int>& start)
 {
-  std::stack<StateSch> stack;
-  set<StateSch> comst;
-  set<StateSch> initials;
-  set<StateSch> finals;
-  //set<StateSch> succ;
-  set<int> alph = getAlphabet();
-  map<std::pair<StateSch, int>, set<StateSch> > mp;
-  map<std::pair<StateSch, int>, set<StateSch> >::iterator it;
+  vector<set<int>> starts = {start};
+  return this->complementSchNFA(starts);
+}
 
-  StateSch init = {start, set<int>(), RankFunc(), 0, false};
-  stack.push(init);
-  comst.insert(init);
-  initials.insert(init);
+
+/*
+ * Get deterministic parts in Schewe construction from several initial
+ * macrostates as one automaton (sharing common macrostates)
+ * @param starts Initial macrostates
+ * @return Deterministic part (NFA part)
+ */
+BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchNFA(const vector<set<int>>& starts)
+{
+  size_t words = this->subsetKernel.getWords();
+  if(words <= 1)
+    return complementSchNFAKernel<BitMacrostate<1>>(starts);
+  else if(words <= 2)
+    return complementSchNFAKernel<BitMacrostate<2>>(starts);
+  else if(words <= 4)
+    return complementSchNFAKernel<BitMacrostate<4>>(starts);
+  return complementSchNFAKernel<BitMacrostate<0>>(starts);
+}
 
 
-  while(stack.size() > 0)
+/*
+ * Get deterministic part in Schewe construction (subset construction over
+ * bitset macrostates)
+ * @param starts Initial macrostates
+ * @return Deterministic part (NFA part)
+ */
+template <typename Macro>
+BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchNFAKernel(const vector<set<int>>& starts)
+{
+  size_t words = this->subsetKernel.getWords();
+  set<int> alph = getAlphabet();
+  vector<int> alphVec(alph.begin(), alph.end());
+  std::unordered_map<Macro, int, BitMacrostateHash<Macro>> ids;
+  vector<Macro> macros;
+  vector<int> succ;
+  vector<int> inits;
+
+  for(const set<int>& start : starts)
   {
-    StateSch st = stack.top();
-    stack.pop();
-    if(isSchFinal(st))
-      finals.insert(st);
+    Macro init = BitSet::fromSet<Macro>(start, words);
+    auto ins = ids.emplace(init, macros.size());
+    if(ins.second)
+      macros.push_back(init);
+    inits.push_back(ins.first->second);
+  }
 
-    for(int sym : alph)
+  Macro dst(words);
+  for(size_t act = 0; act < macros.size(); act++)
+  {
+    for(int sym : alphVec)
     {
-      auto pr = std::make_pair(st, sym);
-      set<StateSch> dst;
-      if(!st.tight)
+      this->subsetKernel.post(macros[act], sym, dst);
+      auto it = ids.find(dst);
+      if(it == ids.end())
       {
-        StateSch nt = {succSet(st.S, sym), set<int>(), RankFunc(), 0, false};
-        dst.insert(nt);
-        if(comst.find(nt) == comst.end())
-        {
-          stack.push(nt);
-          comst.insert(nt);
-        }
+        succ.push_back(macros.size());
+        ids.emplace(dst, macros.size());
+        macros.push_back(dst);
+      }
+      else
+      {
+        succ.push_back(it->second);
       }
-      mp[pr] = dst;
     }
   }
 
+  vector<StateSch> schStates;
+  schStates.reserve(macros.size());
+  for(const Macro& m : macros)
+    schStates.push_back({BitSet::toSet(m), set<int>(), RankFunc(), 0, false});
+
+  set<StateSch> comst(schStates.begin(), schStates.end());
+  set<StateSch> initials;
+  for(int i : inits)
+    initials.insert(schStates[i]);
+  set<StateSch> finals;
+  map<std::pair<StateSch, int>, set<StateSch> > mp;
+  for(size_t i = 0; i < schStates.size(); i++)
+  {
+    if(isSchFinal(schStates[i]))
+      finals.insert(schStates[i]);
+    for(size_t j = 0; j < alphVec.size(); j++)
+      mp[{schStates[i], alphVec[j]}] = {schStates[succ[i*alphVec.size() + j]]};
+  }
+
   return BuchiAutomaton<StateSch, int>(comst, finals,
     initials, mp, alph);
 }
@@ -1070,12 +1565,32 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchNFA(set<int>& sta
  */
 bool BuchiAutomatonSpec::acceptSl(StateSch& state, vector<int>& alp)
 {
-  set<int> rel;
+  size_t words = this->subsetKernel.getWords();
+  if(words <= 1)
+    return acceptSlKernel<BitMacrostate<1>>(state, alp);
+  else if(words <= 2)
+    return acceptSlKernel<BitMacrostate<2>>(state, alp);
+  else if(words <= 4)
+    return acceptSlKernel<BitMacrostate<4>>(state, alp);
+  return acceptSlKernel<BitMacrostate<0>>(state, alp);
+}
+
+
+/*
+ * Is the self-loop accepting? (over bitset macrostates)
+ * @param state Macrostate with selfloop
+ * @param alp Alphabet
+ * @return Is sl accepting
+ */
+template <typename Macro>
+bool BuchiAutomatonSpec::acceptSlKernel(StateSch& state, vector<int>& alp)
+{
+  size_t words = this->subsetKernel.getWords();
+  vector<int> rel;
   bool all = true;
   set<int> symAcc;
-  set<int> fin = getFinals();
-  std::stack<set<int>> stack;
-  std::set<set<int>> comst;
+  set<int>& fin = getFinals();
+  std::unordered_set<Macro, BitMacrostateHash<Macro>> comst;
 
   if(state.S.size() == 0)
     return false;
@@ -1083,37 +1598,38 @@ bool BuchiAutomatonSpec::acceptSl(StateSch& state, vector<int>& alp)
   for(int st : state.S)
   {
     if(fin.find(st) != fin.end())
-      rel.insert(st);
+      rel.push_back(st);
   }
   if(rel.size() == 0)
     return false;
+
+  Macro sng(words);
+  Macro act(words);
+  Macro dst(words);
   for(const int& a : alp)
   {
     for(int st : rel)
     {
       all = false;
-      set<int> sng = {st};
-      stack = std::stack<set<int>>();
+      sng = Macro(words);
+      BitSet::insert(sng, st);
+      this->subsetKernel.post(sng, a, act);
       comst.clear();
-      stack.push(succSet(sng, a));
-      comst.insert(succSet(sng, a));
+      comst.insert(act);
 
-      while(stack.size() > 0)
+      // the post-images over a form a lasso
+      while(true)
       {
-        set<int> pst = stack.top();
-        stack.pop();
-        if(pst.find(st) != pst.end())
+        if(BitSet::contains(act, st))
         {
           symAcc.insert(a);
           all = true;
           break;
         }
-        set<int> dst = succSet(pst, a);
-        if(comst.find(dst) == comst.end())
-        {
-          stack.push(dst);
-          comst.insert(dst);
-        }
+        this->subsetKernel.post(act, a, dst);
+        if(!comst.insert(dst).second)
+          break;
+        std::swap(act, dst);
       }
       if(all) break;
     }
@@ -1175,8 +1691,8 @@ void BuchiAutomatonSpec::topologicalSortUtil(std::set<int> currentScc, std::vect
   for (auto scc : allSccs){
     if (not visited[scc]){
       for (auto state : currentScc){
-        for (auto a : this->getAlph()){
-          if (std::any_of(scc.begin(), scc.end(), [this, state, a](int succ){auto trans = this->getTransitions(); return trans[{state, a}].find(succ) != trans[{state, a}].end();}))
+        for (auto a : this->getAlphabet()){
+          if (std::any_of(scc.begin(), scc.end(), [this, state, a](int succ){return this->getTransitionsCSR().hasTransition(state, a, succ);}))
             this->topologicalSortUtil(scc, allSccs, visited, Stack);
         }
       }
@@ -1230,7 +1746,7 @@ unsigned BuchiAutomatonSpec::elevatorStates(){
         if (not det)
           break;
         unsigned trans = 0;
-        for (auto succ : this->getTransitions()[{state, a}]){
+        for (auto succ : this->getTransitionsCSR().successors(state, a)){
           if (scc.find(succ) != scc.end()){
             if (trans > 0){
               det = false;
@@ -1300,7 +1816,7 @@ void BuchiAutomatonSpec::elevatorRank(BuchiAutomaton<StateSch, int> nfaSchewe){
         if (not det)
           break;
         unsigned trans = 0;
-        for (auto succ : this->getTransitions()[{state, a}]){
+        for (auto succ : this->getTransitionsCSR().successors(state, a)){
           if (scc.find(succ) != scc.end()){
             if (trans > 0){
               det = false;
@@ -1386,7 +1902,7 @@ void BuchiAutomatonSpec::elevatorRank(BuchiAutomaton<StateSch, int> nfaSchewe){
         for (auto state : sortedComponents[i-1]){
           for (auto a : this->getAlphabet()){
             unsigned trans = 0;
-            for (auto succ : this->getTransitions()[{state, a}]){
+            for (auto succ : this->getTransitionsCSR().successors(state, a)){
               if (sortedComponents[i-1].find(succ) != sortedComponents[i-1].end()){
                 if (trans > 0){
                   det = false;
@@ -1421,7 +1937,7 @@ void BuchiAutomatonSpec::elevatorRank(BuchiAutomaton<StateSch, int> nfaSchewe){
         for (auto state : sortedComponents[i-1]){
           for (auto a : this->getAlphabet()){
             unsigned trans = 0;
-            for (auto succ : this->getTransitions()[{state, a}]){
+            for (auto succ : this->getTransitionsCSR().successors(state, a)){
               if (sortedComponents[i-1].find(succ) != sortedComponents[i-1].end()){
                 if (trans > 0){
                   det = false;
@@ -1523,9 +2039,13 @@ void BuchiAutomatonSpec::elevatorRank(BuchiAutomaton<StateSch, int> nfaSchewe){
  * @param slignore Self-loops to be ignored
  * @param maxReachSize Maximum reachable macrostate
  * @param minReachSize Minimum reachable macrostate
+ * @param stats Statistics (number of evaluated and cached subsets), may be null
+ * @param fixed Macrostates with already known rank bounds (their successors
+ *   need not be in nfaSchewe), may be null
  * @return Rank bound for each macrostate
  */
-map<DFAState, RankBound> BuchiAutomatonSpec::getRankBound(BuchiAutomaton<StateSch, int>& nfaSchewe, set<StateSch>& slignore, map<DFAState, int>& maxReachSize, map<int, int>& minReachSize)
+map<DFAState, RankBound> BuchiAutomatonSpec::getRankBound(BuchiAutomaton<StateSch, int>& nfaSchewe, set<StateSch>& slignore, map<DFAState, int>& maxReachSize, map<int, int>& minReachSize, Stat *stats,
+    const map<DFAState, int>* fixed)
 {
   set<int> nofin;
   set<int> fin = this->getFinals();
@@ -1533,39 +2053,128 @@ map<DFAState, RankBound> BuchiAutomatonSpec::getRankBound(BuchiAutomaton<StateSc
     fin.end(), std::inserter(nofin, nofin.begin()));
   vector<int> states(nofin.begin(), nofin.end());
   map<StateSch, int> rnkmap;
-  map<set<int>, int> classesMap;
-  int classes;
 
   bool sd = false;
   if(this->opt.semidetOpt && this->isSemiDeterministic())
     sd = true;
-
-  for(const StateSch& s : nfaSchewe.getStates())
-  {
-    rnkmap[s] = 0;
-  }
-
-  for(const StateSch& s : nfaSchewe.getStates())
-  {
-    for(vector<int>& sub : Aux::getAllSubsets(vector<int>(s.S.begin(), s.S.end())))
+  int bound = sd ? 3 : INF;
+
+  // number of classes of the odd rank simulation on each subset (shared by
+  // all macrostates and all threads)
+  typedef BitMacrostate<0> Subset;
+  std::unordered_map<Subset, int, BitMacrostateHash<Subset>> classesMap;
+  std::mutex classesMtx;
+  size_t words = (this->getStates().size() + 63) / 64;
+  size_t relBytes = this->getStates().size() * words * sizeof(uint64_t);
+  std::atomic<size_t> evaluated(0);
+  std::atomic<size_t> cached(0);
+
+  vector<int> inv;
+  RankSimulation rankSim = this->getRankSimulation(inv);
+  BitRelation dirSim(this->getStates().size());
+  for(const auto& pr : this->getDirectSim())
+    dirSim.insert(pr.first, pr.second);
+
+  // macrostates are evaluated independently by opt.threads threads
+  vector<StateSch> macros(nfaSchewe.getStates().begin(), nfaSchewe.getStates().end());
+  vector<int> macroRank(macros.size());
+  TaskGraph::parallelFor(this->opt.threads, macros.size(), [&](size_t ind) {
+    const StateSch& s = macros[ind];
+    if(fixed != nullptr && fixed->find(s.S) != fixed->end())
+      return;
+    vector<int> elems(s.S.begin(), s.S.end());
+    int k = elems.size();
+    int m = 0;
+    // subsets are enumerated as 64-bit masks; a proper subset may have more
+    // classes than the whole macrostate, so larger macrostates fall back to
+    // the trivial bound |S \ F|
+    if(k >= 64)
     {
-      set<int> st(sub.begin(), sub.end());
-
-      if(classesMap.find(st) == classesMap.end())
+      int nonAcc = 0;
+      for(int st : elems)
       {
-        this->computeRankSim(st);
-        classes = Aux::countEqClasses(this->getStates().size(), st, this->getOddRankSim());
+        if(fin.find(st) == fin.end())
+          nonAcc++;
       }
-      else
+      macroRank[ind] = std::min(nonAcc, bound);
+      return;
+    }
+    // simulations of the subsets of the previous level (seeds of their
+    // supersets, the odd rank simulation is monotone wrt the closure)
+    std::unordered_map<uint64_t, BitRelation> prevLevel;
+    std::unordered_map<uint64_t, BitRelation> level;
+
+    auto evalSubset = [&](uint64_t mask, bool keep) {
+      Subset sub(words);
+      set<int> st;
+      for(int i = 0; i < k; i++)
+      {
+        if((mask >> i) & 1)
+        {
+          BitSet::insert(sub, elems[i]);
+          st.insert(st.end(), elems[i]);
+        }
+      }
+      {
+        std::lock_guard<std::mutex> lock(classesMtx);
+        auto it = classesMap.find(sub);
+        if(it != classesMap.end())
+        {
+          cached++;
+          return it->second;
+        }
+      }
+      evaluated++;
+      const BitRelation* seed = &dirSim;
+      for(int i = 0; i < k && seed == &dirSim; i++)
+      {
+        auto itp = prevLevel.find(mask & ~(uint64_t(1) << i));
+        if(((mask >> i) & 1) && itp != prevLevel.end())
+          seed = &itp->second;
+      }
+      BitRelation rel = rankSim.compute(*seed, st);
+      int classes = rel.countClasses(st);
+      {
+        std::lock_guard<std::mutex> lock(classesMtx);
+        classesMap.insert({sub, classes});
+      }
+      if(keep && (level.size() + 1) * relBytes <= RANK_SIM_LEVEL_MEMORY)
+        level.insert({mask, std::move(rel)});
+      return classes;
+    };
+
+    // the whole macrostate first, then only subsets that can raise the maximum
+    // (the number of classes is bounded by the size of the subset)
+    m = evalSubset((uint64_t(1) << k) - 1, false);
+    int j = m + 1;
+    while(j < k && m < bound)
+    {
+      for(uint64_t mask = (uint64_t(1) << j) - 1; mask < (uint64_t(1) << k); )
       {
-        classes = classesMap[st];
+        m = std::max(m, evalSubset(mask, j + 1 < k));
+        // next mask with the same number of bits
+        uint64_t c = mask & -mask;
+        uint64_t r = mask + c;
+        mask = (((r ^ mask) >> 2) / c) | r;
       }
-      rnkmap[s] = std::max(rnkmap[s], classes);
-      if(sd)
+      prevLevel = std::move(level);
+      level.clear();
+      if(m > j)
       {
-        rnkmap[s] = std::min(rnkmap[s], 3);
+        prevLevel.clear();
+        j = m + 1;
       }
+      else
+        j++;
     }
+    macroRank[ind] = std::min(m, bound);
+  });
+  for(size_t i = 0; i < macros.size(); i++)
+    rnkmap.insert(rnkmap.end(), {macros[i], macroRank[i]});
+  if(stats != nullptr)
+  {
+    stats->rankBoundSubsets += evaluated;
+    stats->rankBoundCached += cached;
   }
 
 
@@ -1587,8 +2196,10 @@ map<DFAState, RankBound> BuchiAutomatonSpec::getRankBound(BuchiAutomaton<StateSc
   // cout << " end "  << endl;
 
 
-  auto updMaxFnc = [&slignore] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*> sts) -> int
+  auto updMaxFnc = [&slignore, fixed] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*>& sts) -> int
   {
+    if(fixed != nullptr && fixed->find(a->state.S) != fixed->end())
+      return a->label;
     int m = 0;
     for(const LabelState<StateSch>* tmp : sts)
     {
@@ -1599,8 +2210,14 @@ map<DFAState, RankBound> BuchiAutomatonSpec::getRankBound(BuchiAutomaton<StateSc
     return std::min(a->label, m);
   };
 
-  auto initMaxFnc = [this, &maxReachSize, &minReachSize, &rnkmap] (const StateSch& act) -> int
+  auto initMaxFnc = [this, &maxReachSize, &minReachSize, &rnkmap, fixed] (const StateSch& act) -> int
   {
+    if(fixed != nullptr)
+    {
+      auto it = fixed->find(act.S);
+      if(it != fixed->end())
+        return it->second;
+    }
     set<int> ret;
     set<int> fin = this->getFinals();
     std::set_difference(act.S.begin(),act.S.end(),fin.begin(),
@@ -1651,6 +2268,70 @@ map<DFAState, RankBound> BuchiAutomatonSpec::getRankBound(BuchiAutomaton<StateSc
 }
 
 
+/*
+ * Evaluate rank bounds of the macrostates of this->prep.macros that can
+ * influence the rank bound of a given macrostate (i.e., the macrostates
+ * reachable from it). The propagation is restricted to this region; the
+ * reachable macrostates with already known rank bounds are kept fixed.
+ * @param macro Id of the macrostate
+ * @param slignore Self-loops to be ignored
+ * @param maxReachSize Maximum reachable macrostate
+ * @param minReachSize Minimum reachable macrostate
+ * @param stats Statistics, may be null
+ */
+void BuchiAutomatonSpec::evalRankBoundRegion(int macro, set<StateSch>& slignore, map<DFAState, int>& maxReachSize,
+    map<int, int>& minReachSize, Stat *stats)
+{
+  MacrostateIndex& index = this->prep.macros;
+  set<int> alph = this->getAlphabet();
+  auto toState = [&index](int id) -> StateSch {
+    return { index.get(id), set<int>(), RankFunc(), 0, false };
+  };
+
+  set<StateSch> states;
+  map<std::pair<StateSch, int>, set<StateSch>> trans;
+  map<DFAState, int> fixed;
+  vector<bool> visited(index.size(), false);
+  vector<int> stack = { macro };
+  visited[macro] = true;
+  while(!stack.empty())
+  {
+    int act = stack.back();
+    stack.pop_back();
+    StateSch st = toState(act);
+    states.insert(st);
+    if(index.hasRankBound(act))
+    {
+      fixed[st.S] = index.rankBound[act];
+      continue;
+    }
+    for(int sym : alph)
+    {
+      int dst = index.post(act, sym);
+      if(dst == -1)
+        continue;
+      trans[{st, sym}] = { toState(dst) };
+      if(!visited[dst])
+      {
+        visited[dst] = true;
+        stack.push_back(dst);
+      }
+    }
+  }
+
+  BuchiAutomaton<StateSch, int> region(states, set<StateSch>(), { toState(macro) }, trans, alph);
+  map<DFAState, RankBound> bounds = this->getRankBound(region, slignore, maxReachSize, minReachSize, stats, &fixed);
+  for(const auto& pr : bounds)
+  {
+    if(fixed.find(pr.first) != fixed.end())
+      continue;
+    index.setRankBound(index.find(pr.first), pr.second.bound);
+    if(stats != nullptr)
+      stats->rankBoundMacrostates++;
+  }
+}
+
+
 /*
  * Get maximum reachable macrostate for each macrostate
  * @param nfaSchewe Deterministic part
@@ -1659,7 +2340,7 @@ map<DFAState, RankBound> BuchiAutomatonSpec::getRankBound(BuchiAutomaton<StateSc
  */
 map<DFAState, int> BuchiAutomatonSpec::getMaxReachSize(BuchiAutomaton<StateSch, int>& nfaSchewe, set<StateSch>& slIgnore)
 {
-  auto updMaxFnc = [&slIgnore] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*> sts) -> int
+  auto updMaxFnc = [&slIgnore] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*>& sts) -> int
   {
     int m = 0;
     for(const LabelState<StateSch>* tmp : sts)
@@ -1690,45 +2371,10 @@ map<DFAState, int> BuchiAutomatonSpec::getMaxReachSize(BuchiAutomaton<StateSch,
  */
 map<int, int> BuchiAutomatonSpec::getMinReachSize()
 {
-  set<StateSch> slIgnore;
-  BuchiAutomaton<StateSch, int> comp;
-  map<StateSch, int> mp;
-  map<int, int> ret;
-
-  auto updMaxFnc = [&slIgnore] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*> sts) -> int
-  {
-    int m = 0;
-    for(const LabelState<StateSch>* tmp : sts)
-    {
-      if(tmp->state.S == a->state.S && slIgnore.find(a->state) != slIgnore.end())
-        continue;
-      m = std::max(m, tmp->label);
-    }
-    return std::min(a->label, m);
-  };
-
-  auto initMaxFnc = [] (const StateSch& act) -> int
-  {
-    return act.S.size();
-  };
-
-  for(int st : this->getStates())
-  {
-    set<int> ini = {st};
-    comp = this->complementSchNFA(ini);
-    slIgnore = this->nfaSlAccept(comp);
-    auto sls = comp.getSelfLoops();
-    mp = comp.propagateGraphValues(updMaxFnc, initMaxFnc);
-
-    int val = 1000000;
-    for(auto t : comp.getEventReachable(sls))
-    {
-      val = std::min(val, mp[t]);
-    }
-
-    ret[st] = val;
-  }
-  return ret;
+  map<int, int> minReach;
+  map<int, int> maxReachInd;
+  this->getReachSizes(minReach, maxReachInd);
+  return minReach;
 }
 
 
@@ -1738,12 +2384,67 @@ map<int, int> BuchiAutomatonSpec::getMinReachSize()
  */
 map<int, int> BuchiAutomatonSpec::getMaxReachSizeInd()
 {
+  map<int, int> minReach;
+  map<int, int> maxReachInd;
+  this->getReachSizes(minReach, maxReachInd);
+  return maxReachInd;
+}
+
+
+/*
+ * Get minimum and maximum reachable macrostate sizes for each state of the
+ * original automaton (values of getMinReachSize and getMaxReachSizeInd). The
+ * subset graphs from all singleton starts are built as one shared graph. The
+ * value of a macrostate depends on its successors only, so the values are
+ * propagated once over the shared graph; for each start the minimum over the
+ * eventually reachable macrostates is then obtained by a pass over the SCCs.
+ * The accepting self-loop checks and both propagations are spread over
+ * opt.threads threads.
+ * @param minReach Out parameter: minimum reachable size for each state
+ * @param maxReachInd Out parameter: maximum reachable size for each state
+ */
+void BuchiAutomatonSpec::getReachSizes(map<int, int>& minReach, map<int, int>& maxReachInd)
+{
+  const int none = 1000000;
+  unsigned workers = std::max(1u, this->opt.threads);
+  vector<set<int>> starts;
+  for(int st : this->getStates())
+    starts.push_back({st});
+  BuchiAutomaton<StateSch, int> comp = this->complementSchNFA(starts);
+
+  // index the macrostates
+  vector<StateSch> macros(comp.getStates().begin(), comp.getStates().end());
+  map<StateSch, int> id;
+  for(size_t i = 0; i < macros.size(); i++)
+    id.insert(id.end(), {macros[i], i});
+  AdjList adjList(macros.size());
+  vector<vector<int>> slSymbols(macros.size());
+  for(const auto& t : comp.getTransitions())
+  {
+    int src = id[t.first.first];
+    for(const StateSch& d : t.second)
+    {
+      int dst = id[d];
+      adjList[src].push_back(dst);
+      if(dst == src)
+        slSymbols[src].push_back(t.first.second);
+    }
+  }
+
+  // macrostates with accepting self-loop (as in nfaSlAccept)
+  vector<char> slAccept(macros.size(), 0);
+  TaskGraph::parallelFor(workers, macros.size(), [&](size_t i) {
+    if(slSymbols[i].size() == 1)
+      slAccept[i] = this->acceptSl(macros[i], slSymbols[i]);
+  });
   set<StateSch> slIgnore;
-  BuchiAutomaton<StateSch, int> comp;
-  map<StateSch, int> mp;
-  map<int, int> ret;
+  for(size_t i = 0; i < macros.size(); i++)
+  {
+    if(slAccept[i])
+      slIgnore.insert(slIgnore.end(), macros[i]);
+  }
 
-  auto updMaxFnc = [&slIgnore] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*> sts) -> int
+  auto succValue = [&slIgnore] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*>& sts) -> int
   {
     int m = 0;
     for(const LabelState<StateSch>* tmp : sts)
@@ -1752,31 +2453,83 @@ map<int, int> BuchiAutomatonSpec::getMaxReachSizeInd()
         continue;
       m = std::max(m, tmp->label);
     }
-    return std::max(a->label, m);
+    return m;
   };
-
-  auto initMaxFnc = [] (const StateSch& act) -> int
+  auto updMinFnc = [&succValue] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*>& sts) -> int
   {
-    return act.S.size();
+    return std::min(a->label, succValue(a, sts));
   };
-
-  for(int st : this->getStates())
+  auto updMaxFnc = [&succValue] (LabelState<StateSch>* a, const std::vector<LabelState<StateSch>*>& sts) -> int
   {
-    set<int> ini = {st};
-    comp = this->complementSchNFA(ini);
-    slIgnore = this->nfaSlAccept(comp);
-    auto sls = comp.getSelfLoops();
-    mp = comp.propagateGraphValues(updMaxFnc, initMaxFnc);
+    return std::max(a->label, succValue(a, sts));
+  };
+  auto initFnc = [] (const StateSch& act) -> int
+  {
+    return act.S.size();
+  };
 
-    int val = 1000000;
-    for(auto t : comp.getEventReachable(sls))
+  map<StateSch, int> mpMin;
+  map<StateSch, int> mpMax;
+  TaskGraph::parallelFor(workers, 2, [&](size_t i) {
+    if(i == 0)
+      mpMin = comp.propagateGraphValues(updMinFnc, initFnc);
+    else
+      mpMax = comp.propagateGraphValues(updMaxFnc, initFnc);
+  });
+
+  // SCCs are returned in the reverse topological order; a macrostate is
+  // eventually reachable if it is reachable from a nontrivial SCC or
+  // a self-loop
+  vector<VertItem> vrt;
+  for(size_t i = 0; i < macros.size(); i++)
+    vrt.push_back({(int)i, -1, -1, false});
+  set<int> finals;
+  AutGraph gr(adjList, vrt, finals);
+  gr.computeSCCs();
+
+  // min over reachable macrostates and min over eventually reachable ones
+  vector<int> reachMin(macros.size()), reachMax(macros.size());
+  vector<int> eventMin(macros.size()), eventMax(macros.size());
+  for(const SCC& scc : gr.getAllComponents())
+  {
+    int rMin = none, rMax = none, eMin = none, eMax = none;
+    bool cyclic = scc.size() > 1;
+    for(int st : scc)
     {
-      val = std::min(val, mp[t]);
+      rMin = std::min(rMin, mpMin[macros[st]]);
+      rMax = std::min(rMax, mpMax[macros[st]]);
+      for(int d : adjList[st])
+      {
+        if(d == st)
+          cyclic = true;
+        if(scc.find(d) != scc.end())
+          continue;
+        rMin = std::min(rMin, reachMin[d]);
+        rMax = std::min(rMax, reachMax[d]);
+        eMin = std::min(eMin, eventMin[d]);
+        eMax = std::min(eMax, eventMax[d]);
+      }
+    }
+    if(cyclic)
+    {
+      eMin = rMin;
+      eMax = rMax;
     }
+    for(int st : scc)
+    {
+      reachMin[st] = rMin;
+      reachMax[st] = rMax;
+      eventMin[st] = eMin;
+      eventMax[st] = eMax;
+    }
+  }
 
-    ret[st] = val;
+  for(int st : this->getStates())
+  {
+    int m = id[{set<int>({st}), set<int>(), RankFunc(), 0, false}];
+    minReach[st] = eventMin[m];
+    maxReachInd[st] = eventMax[m];
   }
-  return ret;
 }
 
 
@@ -1786,14 +2539,11 @@ map<int, int> BuchiAutomatonSpec::getMaxReachSizeInd()
  * @param max Vector of maximal ranks (indexed by states)
  * @param states Set of states in a macrostate (the S-set)
  * @param macrostate Current macrostate
- * @param reachCons SuccRank restriction
  * @param reachMax Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param ctx Tight part context
  */
 void BuchiAutomatonSpec::getSchRanksTightOpt(vector<RankFunc>& out, vector<int>& max,
-    set<int>& states, StateSch& macrostate,
-    map<int, int> reachCons, int reachMax, BackRel& dirRel, BackRel& oddRel)
+    set<int>& states, StateSch& macrostate, int reachMax, const TightContext& ctx)
 {
   RankConstr constr;
   map<int, int> sngmap;
@@ -1818,8 +2568,8 @@ void BuchiAutomatonSpec::getSchRanksTightOpt(vector<RankFunc>& out, vector<int>&
     constr.push_back(singleConst);
   }
 
-  out = RankFunc::tightSuccFromRankConstrPure(constr, dirRel, oddRel, macrostate.f.getMaxRank(),
-    reachCons, reachMax, true);
+  out = RankFunc::tightSuccFromRankConstrPure(constr, ctx.dirRel, ctx.oddRel, macrostate.f.getMaxRank(),
+    ctx.reachCons, reachMax, true);
 }
 
 
@@ -1827,14 +2577,10 @@ void BuchiAutomatonSpec::getSchRanksTightOpt(vector<RankFunc>& out, vector<int>&
  * Get all Schewe successros (with RankRestr)
  * @param state Schewe state
  * @param symbol Symbol
- * @param reachCons SuccRank restriction
- * @param maxReach Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param ctx Tight part context
  * @return Set of all successors
  */
-vector<StateSch> BuchiAutomatonSpec::succSetSchTightOpt(StateSch& state, int symbol,
-    map<int, int> reachCons, map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel)
+vector<StateSch> BuchiAutomatonSpec::succSetSchTightOpt(StateSch& state, int symbol, const TightContext& ctx)
 {
   vector<StateSch> ret;
   set<int> sprime;
@@ -1846,16 +2592,16 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchTightOpt(StateSch& state, int sym
 
   for(int st : state.S)
   {
-    set<int> dst = getTransitions()[std::make_pair(st, symbol)];
+    StateRange dst = this->getTransitionsCSR().successors(st, symbol);
     for(int d : dst)
     {
       maxRank[d] = std::min(maxRank[d], state.f[st]);
     }
     sprime.insert(dst.begin(), dst.end());
     if(fin.find(st) == fin.end())
-      succ[st] = dst;
+      succ[st] = set<int>(dst.begin(), dst.end());
 
-    if(state.f.find(st)->second == 0 && reachCons[st] > 0)
+    if(state.f.find(st)->second == 0 && ctx.reachCons[st] > 0)
     {
       return ret;
     }
@@ -1865,7 +2611,9 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchTightOpt(StateSch& state, int sym
     }
   }
 
-  if(this->rankBound[state.S].bound*2-1 < state.f.getMaxRank() || this->rankBound[sprime].bound*2-1 < state.f.getMaxRank())
+  int macro = ctx.macros.find(state.S);
+  int macroPrime = ctx.macros.post(macro, symbol);
+  if(ctx.macros.getRankBound(macro)*2-1 < state.f.getMaxRank() || ctx.macros.getRankBound(macroPrime)*2-1 < state.f.getMaxRank())
   {
     return ret;
   }
@@ -1891,16 +2639,15 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchTightOpt(StateSch& state, int sym
     oprime = succSet(state.O, symbol);
   }
 
-  int maxReachAct = maxReach[sprime];
+  int maxReachAct = ctx.macros.getMaxReach(macroPrime);
   vector<RankFunc> ranks;
   vector<RankFunc> tmp;
   set<int> inverseRank;
 
-  if(!getRankSuccCache(tmp, state, symbol))
+  if(!getRankSuccCache(tmp, state, macro, symbol, this->rankCache))
   {
-    getSchRanksTightOpt(tmp, maxRank, sprime, state,
-        reachCons, maxReachAct, dirRel, oddRel);
-    this->rankCache[{state.S, symbol, state.f.getMaxRank()}].push_back({state.f, tmp});
+    getSchRanksTightOpt(tmp, maxRank, sprime, state, maxReachAct, ctx);
+    this->rankCache[{macro, symbol, state.f.getMaxRank()}].push_back({state.f, tmp});
   }
 
   for (auto& r : tmp)
@@ -1922,21 +2669,15 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchTightOpt(StateSch& state, int sym
 
 /*
  * Get starting states of the tight part (with RankRestr)
- * @param state DFA macrostate
- * @param rankBound Maximum rank
- * @param macrostate Current macrostate
- * @param reachCons SuccRank restriction
- * @param maxReach Maximum reachable macrostate
- * @param dirRel Direct simulation
- * @param oddRel Rank simulation
+ * @param macro Id of the DFA macrostate
+ * @param ctx Tight part context
  * @return Set of first states in the tight part
  */
-vector<StateSch> BuchiAutomatonSpec::succSetSchStartOpt(set<int>& state, int rankBound,
-    map<int, int> reachCons, map<DFAState, int> maxReach, BackRel& dirRel,
-    BackRel& oddRel)
+vector<StateSch> BuchiAutomatonSpec::succSetSchStartOpt(int macro, const TightContext& ctx)
 {
   vector<StateSch> ret;
-  set<int> sprime = state;
+  set<int> sprime = ctx.macros.get(macro);
+  int rankBound = ctx.macros.getRankBound(macro);
   set<int> schfinal;
   set<int> fin = getFinals();
   std::set_difference(sprime.begin(),sprime.end(),fin.begin(),
@@ -1950,9 +2691,9 @@ vector<StateSch> BuchiAutomatonSpec::succSetSchStartOpt(set<int>& state, int ran
       maxRank[st] -= 1;
   }
 
-  int reachMaxAct = maxReach[sprime];
+  int reachMaxAct = ctx.macros.getMaxReach(macro);
   RankConstr constr = rankConstr(maxRank, sprime);
-  for(const RankFunc& item : RankFunc::tightFromRankConstrPure(constr, dirRel, oddRel, reachCons, reachMaxAct, true))
+  for(const RankFunc& item : RankFunc::tightFromRankConstrPure(constr, ctx.dirRel, ctx.oddRel, ctx.reachCons, reachMaxAct, true))
   {
     ret.push_back({sprime, set<int>(), item, 0, true});
   }
@@ -1977,8 +2718,11 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchOpt(bool delay, s
   map<std::pair<StateSch, int>, set<StateSch> >::iterator it;
 
   // NFA part of the Schewe construction
+  auto start = std::chrono::high_resolution_clock::now();
   BuchiAutomaton<StateSch, int> comp = this->complementSchNFA(this->getInitials());
   map<std::pair<StateSch, int>, set<StateSch>> prev = comp.getReverseTransitions();
+  auto end = std::chrono::high_resolution_clock::now();
+  stats->waitingPart = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
   //std::cout << comp.toGraphwiz() << std::endl;
 
   set<StateSch> slIgnore = this->nfaSlAccept(comp);
@@ -1991,13 +2735,16 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchOpt(bool delay, s
   comst.insert(nfaStates.begin(), nfaStates.end());
 
   // Compute reachability restrictions
+  start = std::chrono::high_resolution_clock::now();
   map<int, int> reachCons = this->getMinReachSize();
   map<DFAState, int> maxReach = this->getMaxReachSize(comp, slIgnore);
+  end = std::chrono::high_resolution_clock::now();
+  stats->reachSizes = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
 
   mp.insert(comp.getTransitions().begin(), comp.getTransitions().end());
   finals = set<StateSch>(comp.getFinals());
 
-  int newState = this->getTransitions().size(); //Assumes numbered states: from 0, no gaps
+  int newState = this->getStates().size(); //Assumes numbered states: from 0, no gaps
   map<pair<DFAState,int>, StateSch> slTrans;
   for(const auto& pr : slNonEmpty)
   {
@@ -2013,7 +2760,13 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchOpt(bool delay, s
 
 
   // Compute rank upper bound on the macrostates
-  this->rankBound = this->getRankBound(comp, ignoreAll, maxReach, reachCons);
+  start = std::chrono::high_resolution_clock::now();
+  this->rankBound = this->getRankBound(comp, ignoreAll, maxReach, reachCons, stats);
+  end = std::chrono::high_resolution_clock::now();
+  stats->rankBound = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+  MacrostateIndex macros;
+  this->buildMacrostateIndex(macros, comp, maxReach);
+  vector<int> reachConsVec = this->getReachConsVector(reachCons);
   map<StateSch, DelayLabel> delayMp;
   for(const auto& st : comp.getStates())
   {
@@ -2030,12 +2783,15 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchOpt(bool delay, s
   // Compute states necessary to generate in the tight part
   set<StateSch> tightStart;
   map<StateSch, set<int>> tightStartDelay;
+  start = std::chrono::high_resolution_clock::now();
   if (delay){
     BuchiAutomatonDelay<int> delayB(comp);
-    tightStartDelay = delayB.getCycleClosingStates(ignoreAll, delayMp, w, version, stats);
+    tightStartDelay = delayB.getCycleClosingStates(ignoreAll, delayMp, w, version, stats, this->opt.delayCycleBudget);
   }
   else
     tightStart = comp.getCycleClosingStates(ignoreAll);
+  end = std::chrono::high_resolution_clock::now();
+  stats->cycleClosingStates = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
   std::set<StateSch> tmpSet;
   if (delay){
     for(auto item : tightStartDelay)
@@ -2054,14 +2810,19 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchOpt(bool delay, s
   StateSch init = {getInitials(), set<int>(), RankFunc(), 0, false};
   initials.insert(init);
 
+  start = std::chrono::high_resolution_clock::now();
   set<int> cl;
   this->computeRankSim(cl);
+  end = std::chrono::high_resolution_clock::now();
+  stats->simulations = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
 
   BackRel dirRel = createBackRel(this->getDirectSim());
   BackRel oddRel = createBackRel(this->getOddRankSim());
+  TightContext ctx = { macros, reachConsVec, dirRel, oddRel, false };
 
   bool cnt = true;
 
+  start = std::chrono::high_resolution_clock::now();
   while(stack.size() > 0)
   {
     StateSch st = stack.top();
@@ -2076,11 +2837,11 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchOpt(bool delay, s
       set<StateSch> dst;
       if(st.tight)
       {
-        succ = succSetSchTightOpt(st, sym, reachCons, maxReach, dirRel, oddRel);
+        succ = succSetSchTightOpt(st, sym, ctx);
       }
       else // waiting part
       {
-        succ = succSetSchStartOpt(st.S, rankBound[st.S].bound, reachCons, maxReach, dirRel, oddRel);
+        succ = succSetSchStartOpt(macros.find(st.S), ctx);
         //cout << st.toString() << " : " << succ.size() << endl;
         cnt = false;
       }
@@ -2131,6 +2892,8 @@ BuchiAutomaton<StateSch, int> BuchiAutomatonSpec::complementSchOpt(bool delay, s
     }
     //std::cout << comst.size() << " : " << stack.size() << std::endl;
   }
+  end = std::chrono::high_resolution_clock::now();
+  stats->tightPart = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
 
   return BuchiAutomaton<StateSch, int>(comst, finals,
     initials, mp, alph, getAPPattern());
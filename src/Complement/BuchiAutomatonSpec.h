@@ -14,8 +14,14 @@
 #include "../Algorithms/AuxFunctions.h"
 #include "../Automata/BuchiAutomaton.h"
 #include "BuchiDelay.h"
+#include "BitMacrostate.h"
+#include "PackedStateSch.h"
+#include "StateStore.h"
+#include "MacrostateIndex.h"
 #include "StateKV.h"
 #include "RankFunc.h"
+#include "RankAntichain.h"
+#include "SuccCache.h"
 #include "StateSch.h"
 #include "Options.h"
 
@@ -24,6 +30,9 @@ using std::set;
 using std::map;
 
 enum delayVersion : unsigned;
+
+// memory for rank simulations of subsets kept as seeds in getRankBound (bytes)
+#define RANK_SIM_LEVEL_MEMORY 67108864
 enum sccType {D, ND, BAD, BOTH}; // deterministic with accepting states / nondeterministic without accepting states / bad = nondeterministic with accepting states / both = deterministic without accepting states
 
 struct RankBound
@@ -32,11 +41,61 @@ struct RankBound
   map<int, int> stateBound;
 };
 
-typedef set<int> DFAState;
 /*
- * Successor cache data type
+ * Successor cache data type (keyed by the id of the S-set, the symbol and the
+ * maximum rank)
+ */
+typedef map<std::tuple<int, int, int>, vector<std::pair<RankFunc,vector<RankFunc>>>> SuccRankCache;
+
+/*
+ * Read-only data shared by the successor functions of the tight part
+ */
+struct TightContext
+{
+  // interned S-sets with their rank bounds and maximum reachable sizes
+  const MacrostateIndex& macros;
+  // minimum reachable size of each state of the original automaton
+  const vector<int>& reachCons;
+  BackRel& dirRel;
+  BackRel& oddRel;
+  bool eta4;
+};
+
+/*
+ * Scratch buffers of the tight successor generation (reused over macrostates
+ * and symbols; one per worker)
+ */
+struct TightScratch
+{
+  // maximal rank of each state (-1 for states out of the current successor)
+  vector<int> maxRank;
+};
+
+/*
+ * Preprocessed data of the optimized Schewe construction (shared by the
+ * construction of the whole complement and by the on-the-fly exploration)
  */
-typedef map<std::tuple<DFAState, int, int>, vector<std::pair<RankFunc,vector<RankFunc>>>> SuccRankCache;
+struct SchReducedPrep
+{
+  // waiting part and its reverse transitions
+  BuchiAutomaton<StateSch, int> comp;
+  map<std::pair<StateSch, int>, set<StateSch>> prev;
+  // states accepting the self-loop over a symbol (macrostate, symbol) -> state
+  map<pair<DFAState, int>, int> slStates;
+  map<int, int> slSymbols;
+  // interned macrostates of the waiting part with their rank bounds and
+  // maximum reachable sizes
+  MacrostateIndex macros;
+  // minimum reachable size of each original state
+  vector<int> reachCons;
+  // states of the waiting part with successors in the tight part
+  set<StateSch> tightStart;
+  map<StateSch, set<int>> tightStartDelay;
+  BackRel dirRel;
+  BackRel oddRel;
+  bool delay = false;
+  bool eta4 = false;
+};
 
 /*
  * Specified Buchi automata with complementation
@@ -48,9 +107,19 @@ private:
 
   map<DFAState, RankBound> rankBound;
   SuccRankCache rankCache;
+  SuccExistCache existCache;
+  SubsetKernel subsetKernel;
+  PackedStateStore complStore;
+  StateSchCodec complCodec;
+  SchReducedPrep prep;
 
   ComplOptions opt;
 
+  template <typename Macro>
+  BuchiAutomaton<StateSch, int> complementSchNFAKernel(const vector<set<int>>& starts);
+  template <typename Macro>
+  bool acceptSlKernel(StateSch& state, vector<int>& alp);
+
 protected:
   RankConstr rankConstr(vector<int>& max, set<int>& states);
   set<int> succSet(set<int>& state, int symbol);
@@ -61,56 +130,75 @@ protected:
 
   vector<RankFunc> getSchRanks(vector<int>& max, std::set<int>& states, StateSch& macrostate);
   void getSchRanksTight(vector<RankFunc>& out, vector<int>& max, set<int>& states,
-      StateSch& macrostate, map<int, int> reachCons, int reachMax,
-      BackRel& dirRel, BackRel& oddRel);
-  vector<StateSch> succSetSchStart(set<int>& state, int rankBound, map<int, int> reachCons,
-      map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel);
-  vector<StateSch> succSetSchTight(StateSch& state, int symbol, map<int, int> reachCons,
-      map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel);
+      StateSch& macrostate, int reachMax, const TightContext& ctx);
+  vector<StateSch> succSetSchStart(int macro, const TightContext& ctx);
+  vector<StateSch> succSetSchTight(StateSch& state, int symbol, const TightContext& ctx);
   bool isSchFinal(StateSch& state) const { return state.tight ? state.O.size() == 0 : state.S.size() == 0; }
-  bool getRankSuccCache(vector<RankFunc>& out, StateSch& state, int symbol);
+  bool getRankSuccCache(vector<RankFunc>& out, StateSch& state, int macro, int symbol, SuccRankCache& cache);
+  void buildMacrostateIndex(MacrostateIndex& index, BuchiAutomaton<StateSch, int>& comp, map<DFAState, int>& maxReach);
+  vector<int> getReachConsVector(map<int, int>& reachCons);
 
 
   void getSchRanksTightReduced(vector<RankFunc>& out, vector<int>& max,
-      set<int>& states, int symbol, StateSch& macrostate,
-      map<int, int> reachCons, int reachMax, BackRel& dirRel, BackRel& oddRel);
-  vector<StateSch> succSetSchStartReduced(set<int>& state, int rankBound, map<int, int> reachCons,
-      map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel);
-  vector<StateSch> succSetSchTightReduced(StateSch& state, int symbol, map<int, int> reachCons,
-      map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel, bool eta4);
+      set<int>& states, int macro, int symbol, StateSch& macrostate,
+      int reachMax, const TightContext& ctx, SuccExistCache& cache);
+  vector<StateSch> succSetSchStartReduced(int macro, const TightContext& ctx);
+  vector<StateSch> succSetSchTightReduced(StateSch& state, int symbol, const TightContext& ctx,
+      SuccExistCache& cache);
+  void succSetSchTightReducedAll(StateSch& state, const vector<int>& alph, const TightContext& ctx,
+      SuccExistCache& cache, TightScratch& scratch, vector<vector<StateSch>>& out);
 
   bool acceptSl(StateSch& state, vector<int>& alp);
 
+  vector<StateSch> succSetSchReduced(StateSch& state, int symbol, SuccExistCache& cache);
+
 
   void getSchRanksTightOpt(vector<RankFunc>& out, vector<int>& max,
-      set<int>& states, StateSch& macrostate,
-      map<int, int> reachCons, int reachMax, BackRel& dirRel, BackRel& oddRel);
-  vector<StateSch> succSetSchStartOpt(set<int>& state, int rankBound, map<int, int> reachCons,
-      map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel);
-  vector<StateSch> succSetSchTightOpt(StateSch& state, int symbol, map<int, int> reachCons,
-      map<DFAState, int> maxReach, BackRel& dirRel, BackRel& oddRel);
+      set<int>& states, StateSch& macrostate, int reachMax, const TightContext& ctx);
+  vector<StateSch> succSetSchStartOpt(int macro, const TightContext& ctx);
+  vector<StateSch> succSetSchTightOpt(StateSch& state, int symbol, const TightContext& ctx);
 
 public:
-  BuchiAutomatonSpec(BuchiAutomaton<int, int> &t) : BuchiAutomaton<int, int>(t), rankBound(), rankCache()
+  BuchiAutomatonSpec(BuchiAutomaton<int, int> &t) : BuchiAutomaton<int, int>(t), rankBound(), rankCache(), existCache(), subsetKernel(), complStore(), complCodec(), prep()
   {
     opt = { .cutPoint = false};
+    this->freezeTransitions();
+    this->subsetKernel.build(this->getTransitionsCSR());
   }
 
   BuchiAutomaton<StateKV, int> complementKV();
   BuchiAutomaton<StateSch, int> complementSch();
   BuchiAutomaton<StateSch, int> complementSchReduced(bool delay, std::set<int> originalFinals, double w, delayVersion version, bool elevatorRank, bool eta4, Stat *stats);
+  BuchiAutomaton<int, int> complementSchReducedIds(bool delay, std::set<int> originalFinals, double w, delayVersion version, bool elevatorRank, bool eta4, Stat *stats);
+  std::map<int, StateSch> getComplementLabels();
+  bool isComplementTight(int id) const;
   BuchiAutomaton<StateSch, int> complementSchNFA(set<int>& start);
+  BuchiAutomaton<StateSch, int> complementSchNFA(const vector<set<int>>& starts);
+
+  // on-the-fly complement (optimized Schewe construction)
+  void prepareSchReduced(bool delay, std::set<int> originalFinals, double w, delayVersion version, bool elevatorRank, bool eta4, Stat *stats);
+  StateSch initial();
+  vector<StateSch> successors(StateSch& state, int symbol);
+  bool isAccepting(StateSch& state);
+  StateSchCodec getImplicitCodec();
   //BuchiAutomaton<StateSch, int> complementSchOpt(bool delay);
   BuchiAutomaton<StateSch, int> complementSchOpt(bool delay, std::set<int> originalFinals, double w, delayVersion version, Stat *stats);
 
   set<StateSch> nfaSlAccept(BuchiAutomaton<StateSch, int>& nfaSchewe);
   set<pair<DFAState,int>> nfaSingleSlNoAccept(BuchiAutomaton<StateSch, int>& nfaSchewe);
-  map<DFAState, RankBound> getRankBound(BuchiAutomaton<StateSch, int>& nfaSchewe, set<StateSch>& slignore, map<DFAState, int>& maxReachSize, map<int, int>& minReachSize);
+  map<DFAState, RankBound> getRankBound(BuchiAutomaton<StateSch, int>& nfaSchewe, set<StateSch>& slignore, map<DFAState, int>& maxReachSize, map<int, int>& minReachSize, Stat *stats = nullptr,
+    const map<DFAState, int>* fixed = nullptr);
+  void evalRankBoundRegion(int macro, set<StateSch>& slignore, map<DFAState, int>& maxReachSize, map<int, int>& minReachSize, Stat *stats);
   map<DFAState, int> getMaxReachSize(BuchiAutomaton<StateSch, int>& nfaSchewe, set<StateSch>& slIgnore);
   map<int, int> getMaxReachSizeInd();
   map<int, int> getMinReachSize();
+  void getReachSizes(map<int, int>& minReach, map<int, int>& maxReachInd);
 
-  void setComplOptions(ComplOptions& co) { this->opt = co; }
+  void setComplOptions(ComplOptions& co)
+  {
+    this->opt = co;
+    this->existCache.setBudget(co.CacheMaxBytes);
+  }
   ComplOptions getComplOptions() const { return this->opt; }
 
   void elevatorRank(BuchiAutomaton<StateSch, int> nfaSchewe);
@@ -1,282 +1,332 @@
 
 #include "BuchiDelay.h"
 
-int fact(int n)
+/*
+ * Priority queue of states of the delay heuristic ordered by their scores
+ * (ties are broken by the maximum rank and the index of the state). Keys can
+ * be updated in place.
+ */
+class DelayQueue
 {
-    int res = 1;
-    for (int i = 2; i <= n; i++)
-        res = res * i;
-    return res;
-}
+private:
+  std::vector<double> score;
+  std::vector<unsigned> rank;
+  std::vector<int> heap;
+  std::vector<int> pos;
+
+  bool less(int a, int b) const
+  {
+    if(this->score[a] != this->score[b])
+      return this->score[a] < this->score[b];
+    if(this->rank[a] != this->rank[b])
+      return this->rank[a] < this->rank[b];
+    return a < b;
+  }
 
-int nCr(int n, int r)
-{
-    return fact(n) / (fact(r) * fact(n - r));
-}
+  void swap(size_t i, size_t j)
+  {
+    std::swap(this->heap[i], this->heap[j]);
+    this->pos[this->heap[i]] = i;
+    this->pos[this->heap[j]] = j;
+  }
 
-template<typename Symbol>
-unsigned BuchiAutomatonDelay<Symbol> :: getAllPossibleRankings(unsigned maxRank, unsigned accStates, unsigned nonAccStates, delayVersion version){
-
-  // OLD VERSION
-  if (version == oldVersion){
-    unsigned even = std::pow(((maxRank+1)/2), accStates);
-    unsigned odd = 0;
-    unsigned tmpSum = 1;
-    unsigned tmp;
-    unsigned upperBound = nonAccStates - (maxRank-1)/2;
-    unsigned innerUpperBound;
-    for (unsigned r=0; r<=(maxRank-1)/2; r++){
-      // every rank
-      innerUpperBound = nonAccStates - (maxRank-1)/2 + 1 + r;
-      tmp = [](unsigned upperBound, unsigned innerUpperBound, unsigned tmpSum){
-        unsigned tmpVar = 0;
-        for (unsigned i=1; i<=upperBound; i++){
-          tmpVar += (nCr(innerUpperBound, i) * tmpSum);
-        }
-        return tmpVar;
-      }(upperBound, innerUpperBound, tmpSum);
-      tmpSum = tmp;
-      odd = tmp;
+  void siftUp(size_t i)
+  {
+    while(i > 0 && this->less(this->heap[i], this->heap[(i-1)/2]))
+    {
+      this->swap(i, (i-1)/2);
+      i = (i-1)/2;
     }
+  }
 
-    return odd*even;
+  void siftDown(size_t i)
+  {
+    while(true)
+    {
+      size_t m = i;
+      for(size_t c = 2*i + 1; c <= 2*i + 2 && c < this->heap.size(); c++)
+      {
+        if(this->less(this->heap[c], this->heap[m]))
+          m = c;
+      }
+      if(m == i)
+        return;
+      this->swap(i, m);
+      i = m;
+    }
   }
 
-  // NEW VERSION
-  else if (version == newVersion or version == subsetVersion){
-    unsigned even = std::pow(((maxRank+1)/2), accStates);
-    unsigned oddSum = 0;
-    unsigned rank;
-
-    for (unsigned count = 0; count < (maxRank+1)/2; count++){
-      unsigned odd = 0;
-      unsigned tmpSum = 1;
-      unsigned tmp;
-      rank = 2*count + 1;
-      unsigned upperBound = nonAccStates - (rank-1)/2;
-      unsigned innerUpperBound;
-
-      if (nonAccStates < (rank-1)/2)
-        continue;
-      if (rank == 1 and nonAccStates > 0)
-        odd = 1;
-      for (unsigned r=0; r<(rank-1)/2; r++){
-        innerUpperBound = nonAccStates - (rank-1)/2 + 1 + r;
-
-        tmp = [](unsigned upperBound, unsigned innerUpperBound, unsigned tmpSum){
-          unsigned tmpVar = 0;
-          for (unsigned i=1; i<=upperBound; i++){
-            tmpVar += (nCr(innerUpperBound, i) * tmpSum);
-          }
-          return tmpVar;
-        }(upperBound, innerUpperBound, tmpSum);
+public:
+  DelayQueue(const std::vector<unsigned>& rank) : score(rank.size(), 0.0), rank(rank), heap(), pos(rank.size(), -1) { }
 
-        tmpSum = tmp;
-        odd = tmp;
-      }
+  bool empty() const { return this->heap.empty(); }
+  bool contains(int st) const { return this->pos[st] != -1; }
+  int top() const { return this->heap[0]; }
+  double getScore(int st) const { return this->score[st]; }
 
-      oddSum += odd;
-    }
+  void push(int st, double val)
+  {
+    this->score[st] = val;
+    this->pos[st] = this->heap.size();
+    this->heap.push_back(st);
+    this->siftUp(this->pos[st]);
+  }
 
-    return oddSum*even;
+  void update(int st, double val)
+  {
+    this->score[st] = val;
+    this->siftUp(this->pos[st]);
+    this->siftDown(this->pos[st]);
   }
 
-  // VERSION WITH STIRLING NUMBERS
-  else {
-    unsigned even = std::pow(((maxRank+1)/2), accStates);
-    unsigned count = (maxRank+1)/2;
-    unsigned odd = 0;
-
-    for (unsigned tmpCount = 1; tmpCount <= count; tmpCount++){
-      odd += [nonAccStates, tmpCount](){
-        unsigned tmp = 0;
-        for (unsigned i=0; i<=tmpCount; i++){
-          int sign = 1;
-          if (i%2 == 1)
-            sign = -1;
-          tmp += sign * nCr(tmpCount, i) * std::pow(tmpCount-i, nonAccStates);
-        }
-        return tmp;
-      }();
+  void remove(int st)
+  {
+    size_t i = this->pos[st];
+    this->swap(i, this->heap.size() - 1);
+    this->heap.pop_back();
+    this->pos[st] = -1;
+    if(i < this->heap.size())
+    {
+      this->siftUp(i);
+      this->siftDown(i);
     }
+  }
+};
+
 
-    return odd * even;
+/*
+ * Index the states and build the adjacency list of the automaton
+ */
+template <typename Symbol>
+void BuchiAutomatonDelay<Symbol> :: buildGraph() {
+  this->vert.clear();
+  this->index.clear();
+  for (const StateSch& st : this->getStates()){
+    this->index.insert(this->index.end(), {st, this->vert.size()});
+    this->vert.push_back(st);
+  }
+
+  this->adjList = AdjList(this->vert.size());
+  for (const auto& t : this->getTransitions()){
+    auto src = this->index.find(t.first.first);
+    if (src == this->index.end())
+      continue;
+    for (const StateSch& d : t.second){
+      auto dst = this->index.find(d);
+      if (dst != this->index.end())
+        this->adjList[src->second].push_back(dst->second);
+    }
+  }
+  for (auto& succ : this->adjList){
+    std::sort(succ.begin(), succ.end());
+    succ.erase(std::unique(succ.begin(), succ.end()), succ.end());
   }
 }
 
 /*
- * Get states closing a cycle in the automaton graph
+ * Get states closing a cycle in the automaton graph. Elementary cycles are
+ * enumerated (with a budget per SCC), then the states are greedily chosen by
+ * their scores until all cycles are covered. States of SCCs exceeding the
+ * budget are chosen as a feedback vertex set of the SCC instead.
  * @params slignore States containing self-loops to be ignored
  * @params dmap Delay map (mapping assigning information about macrostates for the Delay optimization)
+ * @params budget Maximum number of cycles enumerated in a single SCC (0 = unlimited)
  * @return Set of states and symbols for which transitions to the tight part should be generated
  */
 template <typename Symbol>
-std::map<StateSch, std::set<Symbol>> BuchiAutomatonDelay<Symbol> :: getCycleClosingStates(set<StateSch>& slignore, DelayMap<StateSch>& dmap, double w, delayVersion version, Stat *stats) {
+std::map<StateSch, std::set<Symbol>> BuchiAutomatonDelay<Symbol> :: getCycleClosingStates(set<StateSch>& slignore, DelayMap<StateSch>& dmap, double w, delayVersion version, Stat *stats,
+    size_t budget) {
 
   std::map<StateSch, std::set<Symbol>> statesToGenerate;
-  std::vector<std::vector<StateSch>> allCycles;
-  std::map<StateSch, double> mapping;
-  std::set<StateSch> successors;
-  std::set<StateSch> allStates = this->getStates();
-  std::set<StateSch> tmpStates;
-  std::vector<std::vector<StateSch>> tmpCycles;
-  std::set<StateSch> cycleSucc;
-  StateSch minState;
-  auto trans = this->getTransitions();
+  std::vector<std::vector<int>> allCycles;
+  std::vector<int> sccOf;
+  std::vector<bool> overBudget;
+  const auto& trans = this->getTransitions();
   srand(time(0));
 
   // get all cycles
   auto start = std::chrono::high_resolution_clock::now();
-  allCycles = this->getAllCycles();
+  this->getAllCycles(budget, allCycles, sccOf, overBudget);
   auto end = std::chrono::high_resolution_clock::now();
   stats->getAllCycles = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+  stats->delayCycles = allCycles.size();
 
   // states to generate
   start = std::chrono::high_resolution_clock::now();
-  while (not allStates.empty()){
+  int n = this->vert.size();
 
-    // NORMAL
-    if (version == oldVersion or version == newVersion or version == subsetVersion or version == stirlingVersion){
-      mapping.clear();
-      // number for every state
-      for (auto state : allStates){
-        successors = this->getAllSuccessors(state); // all successors
-        std::set<StateSch> tmpSucc = successors;
-
-        for (auto succ : successors){
-          if (not std::any_of(allCycles.begin(), allCycles.end(), [state, succ](std::vector<StateSch> item){
-            return [state, succ, item](){
-              for (unsigned i=0; i<item.size()-1; i++){
-                if (item[i] == state and item[i+1] == succ)
-                  return true;
-              }
-              return false;
-            }();
-          })){tmpSucc.erase(succ);}
+  // symbols of transitions from a state to a given successor
+  auto symbolsTo = [&trans, this](int st, const std::set<int>& succ) {
+    std::set<Symbol> symbols;
+    for (auto a : this->getAlphabet()){
+      auto it = trans.find(std::pair<StateSch, Symbol>(this->vert[st], a));
+      if (it == trans.end())
+        continue;
+      for (int s : succ){
+        if (it->second.find(this->vert[s]) != it->second.end()){
+          symbols.insert(a);
+          break;
         }
-        successors = tmpSucc;
-
-        unsigned rankings = [successors, this, state, version](DelayMap<StateSch> &dmap){
-            unsigned result = 0;
-            for (auto succ : successors){
-              if (dmap[succ].maxRank != 0){
-                result += this->getAllPossibleRankings(dmap[succ].maxRank, dmap[succ].macrostateSize - dmap[succ].nonAccStates, dmap[succ].nonAccStates, version);
-              }
-            }
-            return result;
-          }(dmap);
-
-        // number of cycles with this state that are not covered yet
-        unsigned cycles = [allCycles, state](){
-          unsigned tmp = 0;
-          for (std::vector<StateSch> cycle : allCycles){
-            if (std::find(cycle.begin(), cycle.end(), state) != cycle.end())
-              tmp++;
-          }
-          return tmp;
-        }();
-
-        double result = [rankings, cycles, w](){
-          if (cycles == 0)
-            return 0.0;
-          //return ((double)rankings)/cycles;
-          return std::pow(rankings, w) / std::pow(cycles, 1-w);
-        }();
-        mapping.insert(std::pair<StateSch, double>(state, result));
       }
-
-      // remove states with 0.0
-      tmpStates = allStates;
-      bool removed = false;
-      for (auto state : allStates){
-        if (mapping[state] == 0.0){
-          removed = true;
-          // add them to statesToGenerate with no symbol
-          std::set<Symbol> tmpSymbols;
-          statesToGenerate.insert(std::pair<StateSch, std::set<Symbol>>(state, tmpSymbols));
-          tmpStates.erase(state);
-          // remove all cycles with this state
-          tmpCycles.clear();
-          for (std::vector<StateSch> cycle : allCycles){
-            if (std::find(cycle.begin(), cycle.end(), state) == cycle.end())
-              tmpCycles.push_back(cycle);
-          }
-          allCycles = tmpCycles;
-        }
+    }
+    return symbols;
+  };
+
+  // SCCs exceeding the budget: a feedback vertex set of the SCC with the
+  // transitions staying in the SCC
+  std::set<StateSch> fvs;
+  if (std::find(overBudget.begin(), overBudget.end(), true) != overBudget.end())
+    fvs = BuchiAutomaton<StateSch, Symbol>::getCycleClosingStates(slignore);
+  std::vector<bool> active(n, true);
+  for (int st = 0; st < n; st++){
+    if (not overBudget[sccOf[st]])
+      continue;
+    active[st] = false;
+    std::set<int> sccSucc;
+    if (fvs.find(this->vert[st]) != fvs.end()){
+      for (int d : this->adjList[st]){
+        if (sccOf[d] == sccOf[st])
+          sccSucc.insert(d);
       }
-      allStates = tmpStates;
-      if (removed)
+    }
+    statesToGenerate.insert({this->vert[st], symbolsTo(st, sccSucc)});
+  }
+  stats->delayOverBudget = std::count(overBudget.begin(), overBudget.end(), true);
+
+  // index from states and transitions to (not yet covered) cycles
+  std::vector<std::vector<int>> stateCycles(n);
+  std::vector<std::map<int, unsigned>> edgeCycles(n);
+  std::vector<bool> alive(allCycles.size(), true);
+  for (size_t c = 0; c < allCycles.size(); c++){
+    const std::vector<int>& cycle = allCycles[c];
+    for (size_t i = 0; i < cycle.size(); i++){
+      stateCycles[cycle[i]].push_back(c);
+      edgeCycles[cycle[i]][cycle[(i+1) % cycle.size()]]++;
+    }
+  }
+
+  // numbers of rankings of the states (tabulated once)
+  std::vector<unsigned> maxRank(n);
+  unsigned tableRank = 0;
+  unsigned tableStates = 0;
+  for (int st = 0; st < n; st++){
+    const DelayLabel& lab = dmap[this->vert[st]];
+    maxRank[st] = lab.maxRank;
+    tableRank = std::max(tableRank, lab.maxRank);
+    tableStates = std::max(tableStates, lab.macrostateSize);
+  }
+  RankingCounts counts(version, tableRank, tableStates);
+  std::vector<double> succRankings(n, 0.0);
+  for (int st = 0; st < n; st++){
+    const DelayLabel& lab = dmap[this->vert[st]];
+    if (lab.maxRank != 0)
+      succRankings[st] = (double)counts.get(lab.maxRank, lab.macrostateSize - lab.nonAccStates, lab.nonAccStates);
+  }
+
+  // rankings of the successors on uncovered cycles and the scores
+  std::vector<double> rankings(n, 0.0);
+  std::vector<unsigned> cycles(n);
+  auto sumRankings = [&edgeCycles, &succRankings](int st) {
+    double sum = 0.0;
+    for (const auto& e : edgeCycles[st]){
+      if (e.second > 0)
+        sum += succRankings[e.first];
+    }
+    return sum;
+  };
+  for (int st = 0; st < n; st++){
+    rankings[st] = sumRankings(st);
+    cycles[st] = stateCycles[st].size();
+  }
+  auto score = [&rankings, &cycles, w](int st) {
+    if (cycles[st] == 0)
+      return 0.0;
+    return std::pow(rankings[st], w) / std::pow(cycles[st], 1-w);
+  };
+
+  DelayQueue queue(maxRank);
+  std::vector<int> remaining;
+  for (int st = 0; st < n; st++){
+    if (active[st]){
+      queue.push(st, score(st));
+      remaining.push_back(st);
+    }
+  }
+
+  // cover all cycles containing a state
+  auto cover = [&](int st) {
+    std::set<int> touched;
+    std::set<int> changed;
+    for (int c : stateCycles[st]){
+      if (not alive[c])
         continue;
+      alive[c] = false;
+      const std::vector<int>& cycle = allCycles[c];
+      for (size_t i = 0; i < cycle.size(); i++){
+        int succ = cycle[(i+1) % cycle.size()];
+        if (--edgeCycles[cycle[i]][succ] == 0)
+          changed.insert(cycle[i]);
+        cycles[cycle[i]]--;
+        touched.insert(cycle[i]);
+      }
+    }
+    for (int t : changed)
+      rankings[t] = sumRankings(t);
+    if (queue.contains(st))
+      queue.remove(st);
+    for (int t : touched){
+      if (queue.contains(t))
+        queue.update(t, score(t));
+    }
+  };
 
-      // pick min
-      double min = -1.0;
-      bool first = true;
-      if (allStates.size() == 0)
-        break;
-      for (auto state : allStates){
-        if (first or (mapping[state] <= min and dmap[state].maxRank < dmap[minState].maxRank)) {
-          minState = state;
-          min = mapping[state];
-          first = false;
-        }
+  std::set<int> cycleSucc;
+  while (not queue.empty()){
+    int minState;
+
+    // NORMAL
+    if (version == oldVersion or version == newVersion or version == subsetVersion or version == stirlingVersion){
+      minState = queue.top();
+      // states with 0.0 are generated with no symbol
+      if (queue.getScore(minState) == 0.0){
+        statesToGenerate.insert({this->vert[minState], std::set<Symbol>()});
+        cover(minState);
+        continue;
       }
 
       if (version == subsetVersion){
-        if constexpr (std::is_same<StateSch, StateSch>::value){
-          auto tmpStates = allStates;
-          auto revTrans = this->getReverseTransitions();
-          for (auto succ : cycleSucc){
-            for (auto state : allStates){
-              std::set<int> tmpSet;
-              std::set_difference(state.S.begin(), state.S.end(), succ.S.begin(), succ.S.end(), std::inserter(tmpSet, tmpSet.begin()));
-              if (tmpSet.size() == 0 and std::find(tmpStates.begin(), tmpStates.end(), state) != tmpStates.end())
-                minState = state;
-            }
+        for (int succ : cycleSucc){
+          for (int st = 0; st < n; st++){
+            const std::set<int>& S = this->vert[st].S;
+            const std::set<int>& succS = this->vert[succ].S;
+            if (queue.contains(st) and std::includes(succS.begin(), succS.end(), S.begin(), S.end()))
+              minState = st;
           }
-          allStates = tmpStates;
         }
       }
     }
 
     // RANDOM
-    else if (version == randomVersion){
+    else {
       // randomly pick one state to generate
-      auto it = allStates.cbegin();
-      int random = rand() % allStates.size();
-      std::advance(it, random);
-      minState = *it;
+      remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&queue](int st) {
+        return not queue.contains(st);
+      }), remaining.end());
+      minState = remaining[rand() % remaining.size()];
     }
 
     // which transitions should be generated
-    std::set<Symbol> symbols;
     cycleSucc.clear();
-    for (auto cycle : allCycles){
-      for (unsigned i = 0; i < cycle.size()-1; i++){
-        if (cycle[i] == minState){
-          cycleSucc.insert(cycle[i+1]);
-          break;
-        }
-      }
-    }
-
-    for (auto succ : cycleSucc){
-      for (auto a : this->getAlphabet()){
-        std::set<StateSch> reachStates = trans[std::pair<StateSch, Symbol>(minState, a)];
-        if (reachStates.find(succ) != reachStates.end())
-          symbols.insert(a);
-      }
-    }
-
-    statesToGenerate.insert(std::pair<StateSch, std::set<Symbol>>(minState, symbols));
-    // remove all cycles with this state
-    tmpCycles.clear();
-    for (std::vector<StateSch> cycle : allCycles){
-      if (std::find(cycle.begin(), cycle.end(), minState) == cycle.end())
-        tmpCycles.push_back(cycle);
+    for (int c : stateCycles[minState]){
+      if (not alive[c])
+        continue;
+      const std::vector<int>& cycle = allCycles[c];
+      auto it = std::find(cycle.begin(), cycle.end(), minState);
+      cycleSucc.insert(cycle[(it - cycle.begin() + 1) % cycle.size()]);
     }
-    allCycles = tmpCycles;
-    allStates.erase(minState);
 
+    statesToGenerate.insert({this->vert[minState], symbolsTo(minState, cycleSucc)});
+    cover(minState);
   }
 
   end = std::chrono::high_resolution_clock::now();
@@ -286,55 +336,55 @@ std::map<StateSch, std::set<Symbol>> BuchiAutomatonDelay<Symbol> :: getCycleClos
 }
 
 template<typename Symbol>
-void BuchiAutomatonDelay<Symbol> :: unblock(int state, std::set<int> &blockedSet, std::map<int, std::set<int>> &blockedMap){
-  blockedSet.erase(state); //
-  for (auto w : blockedMap[state]){
-    blockedMap[state].erase(w); // delete w from blocked maps
-    if (blockedSet.find(w) != blockedSet.end()){ // w is in blockedSet
-      //blockedSet.erase(w); //!
-      this->unblock(w, blockedSet, blockedMap); //
-    }
+void BuchiAutomatonDelay<Symbol> :: unblock(int state, std::vector<bool>& blocked, std::vector<std::set<int>>& blockedMap){
+  blocked[state] = false;
+  std::set<int> tmp;
+  tmp.swap(blockedMap[state]); // delete all w from blocked maps
+  for (int w : tmp){
+    if (blocked[w]) // w is blocked
+      this->unblock(w, blocked, blockedMap);
   }
 }
 
+/*
+ * Johnson's circuit procedure: find elementary cycles through startState
+ * in the SCC scc using states not smaller than startState
+ * @params limit Maximum number of cycles (the search stops when it is exceeded)
+ * @return Was a cycle closed from state?
+ */
 template<typename Symbol>
-bool BuchiAutomatonDelay<Symbol> :: circuit(int state, std::vector<int> &stack, std::set<int> &blockedSet, std::map<int,
-  std::set<int>> &blockedMap, std::set<int> scc, AdjList adjlist, int startState, std::vector<std::vector<int>> &allCyclesRenamed) {
+bool BuchiAutomatonDelay<Symbol> :: circuit(int state, int startState, int scc, const std::vector<int>& sccOf, std::vector<int>& stack,
+    std::vector<bool>& blocked, std::vector<std::set<int>>& blockedMap, std::vector<std::vector<int>>& cycles, size_t limit) {
   bool flag = false;
   stack.push_back(state);
-  blockedSet.insert(state);
+  blocked[state] = true;
 
   // for every successor
-  for (auto succ : adjlist[state]){
+  for (int succ : this->adjList[state]){
+    if (sccOf[succ] != scc or succ < startState)
+      continue;
     if (succ == startState){
       // cycle was closed -> states on stack
       flag = true;
-      std::vector<int> cycle;
-      for (auto state : stack){
-        cycle.push_back(state);
-      }
-      if (not cycle.empty()){
-        cycle.push_back(startState);
-        allCyclesRenamed.push_back(cycle); // add new cycle to the vector of cycles
-      }
+      cycles.push_back(stack); // add new cycle to the vector of cycles
     }
-    else if (blockedSet.find(succ) == blockedSet.end()){ // succ is not in blockedSet
-      // successor is not in the blocked set
-      if (this->circuit(succ, stack, blockedSet, blockedMap, scc, adjlist, startState, allCyclesRenamed)){
+    else if (not blocked[succ]){
+      // successor is not blocked
+      if (this->circuit(succ, startState, scc, sccOf, stack, blocked, blockedMap, cycles, limit))
         flag = true;
-      }
     }
+    if (cycles.size() > limit)
+      break;
   }
 
   if (flag){
     // unblock ...
-    this->unblock(state, blockedSet, blockedMap);
+    this->unblock(state, blocked, blockedMap);
   } else {
     // for every successor
-    for (auto succ : adjlist[state]){
-      if (blockedMap[state].find(succ) == blockedMap[state].end()){ // succ is not in blockedMap[state]
-        blockedMap[state].insert(succ);
-      }
+    for (int succ : this->adjList[state]){
+      if (sccOf[succ] == scc and succ >= startState)
+        blockedMap[succ].insert(state);
     }
   }
 
@@ -342,51 +392,54 @@ bool BuchiAutomatonDelay<Symbol> :: circuit(int state, std::vector<int> &stack,
   return flag;
 }
 
+/*
+ * Enumerate elementary cycles of the automaton (Johnson's algorithm)
+ * @params budget Maximum number of cycles in a single SCC (0 = unlimited)
+ * @params cycles Out parameter: cycles (sequences of state indices)
+ * @params sccOf Out parameter: SCC of each state
+ * @params overBudget Out parameter: SCCs exceeding the budget (their cycles are dropped)
+ */
 template<typename Symbol>
-std::vector<std::vector<StateSch>> BuchiAutomatonDelay<Symbol> :: getAllCycles(){
-  BuchiAutomaton<int, int> renAut = this->renameAut();
-  vector<vector<int>> adjList(this->getStates().size());
+void BuchiAutomatonDelay<Symbol> :: getAllCycles(size_t budget, std::vector<std::vector<int>>& cycles, std::vector<int>& sccOf, std::vector<bool>& overBudget){
+  this->buildGraph();
+  int n = this->vert.size();
   vector<VertItem> vrt;
-  vector<set<StateSch>> sccs;
-
-  renAut.getAutGraphComponents(adjList, vrt);
-  AutGraph gr(adjList, vrt, renAut.getFinals());
+  for (int i = 0; i < n; i++)
+    vrt.push_back({i, -1, -1, false});
+  set<int> finals;
+  AutGraph gr(this->adjList, vrt, finals);
   gr.computeSCCs(); // all sccs
 
-  std::vector<std::vector<int>> allCyclesRenamed;
-  std::vector<std::vector<StateSch>> allCycles;
-  const std::set<int> emptySet;
-  std::vector<std::set<int>> tmpVector;
-
-  for(auto& scc : gr.getAllComponents()){ // for every scc
-    auto tmpScc = scc;
-    for (auto &state : scc){ // for every state in scc
-      std::vector<int> stack;
-      std::set<int> blockedSet;
-      std::map<int, std::set<int>> blockedMap;
-
-      // insert all states in scc to blockedMap
-      for(auto &state : scc){
-        blockedMap.insert(std::pair<int, std::set<int>>(state, emptySet));
-      }
-
-      // circuit method: returns all cycles in allCyclesRenamed
-      this->circuit(state, stack, blockedSet, blockedMap, tmpScc, adjList, state, allCyclesRenamed);
-
-      tmpScc.erase(state);
-      adjList[state].erase(std::remove(adjList[state].begin(), adjList[state].end(), state), adjList[state].end());
-    }
+  SCCs& sccs = gr.getAllComponents();
+  sccOf = std::vector<int>(n, -1);
+  overBudget = std::vector<bool>(sccs.size(), false);
+  for (size_t c = 0; c < sccs.size(); c++){
+    for (int st : sccs[c])
+      sccOf[st] = c;
   }
 
-  for (auto &cycle : allCyclesRenamed){
-    std::vector<StateSch> oneCycle;
-    for (auto &state : cycle){
-      oneCycle.push_back(this->getInvRenameSymbolMap()[state]);
+  std::vector<int> stack;
+  std::vector<bool> blocked(n, false);
+  std::vector<std::set<int>> blockedMap(n);
+  for (size_t c = 0; c < sccs.size(); c++){ // for every scc
+    size_t before = cycles.size();
+    size_t limit = (budget == 0 ? SIZE_MAX : before + budget);
+    for (int state : sccs[c]){ // for every state in scc
+      for (int st : sccs[c]){
+        blocked[st] = false;
+        blockedMap[st].clear();
+      }
+
+      // circuit method: returns all cycles through state in cycles
+      stack.clear();
+      this->circuit(state, state, c, sccOf, stack, blocked, blockedMap, cycles, limit);
+      if (cycles.size() > limit){
+        cycles.resize(before);
+        overBudget[c] = true;
+        break;
+      }
     }
-    allCycles.push_back(oneCycle);
   }
-
-  return allCycles;
 }
 
 template class BuchiAutomatonDelay<int>;
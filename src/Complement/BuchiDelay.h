@@ -7,6 +7,8 @@
 #include <vector>
 #include <stack>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 
 #include <iostream>
 #include <algorithm>
@@ -16,20 +18,28 @@
 #include "StateKV.h"
 #include "RankFunc.h"
 #include "StateSch.h"
+#include "RankingCounts.h"
 
 template <typename Symbol>
 class BuchiAutomatonDelay : public BuchiAutomaton<StateSch, Symbol> {
 
-public:
+private:
+  // states indexed in the order of the state set and their successors
+  std::vector<StateSch> vert;
+  std::map<StateSch, int> index;
+  AdjList adjList;
+
+  void buildGraph();
 
+public:
   BuchiAutomatonDelay(BuchiAutomaton<StateSch, Symbol>& other) : BuchiAutomaton<StateSch, Symbol>(other) { }
 
-  vector<vector<StateSch>> getAllCycles();
-  bool circuit(int state, std::vector<int> &stack, std::set<int> &blockedSet, std::map<int, std::set<int>> &blockedMap,
-    std::set<int> scc, AdjList adjlist, int startState, std::vector<std::vector<int>> &allCyclesRenamed);
-  void unblock(int state, std::set<int> &blockedSet, std::map<int, std::set<int>> &blockedMap);
-  unsigned getAllPossibleRankings(unsigned maxRank, unsigned accStates, unsigned nonAccStates, delayVersion version);
-  std::map<StateSch, std::set<Symbol>> getCycleClosingStates(set<StateSch>& slignore, DelayMap<StateSch>& dmap, double w, delayVersion version, Stat *stats);
+  void getAllCycles(size_t budget, std::vector<std::vector<int>>& cycles, std::vector<int>& sccOf, std::vector<bool>& overBudget);
+  bool circuit(int state, int startState, int scc, const std::vector<int>& sccOf, std::vector<int>& stack,
+    std::vector<bool>& blocked, std::vector<std::set<int>>& blockedMap, std::vector<std::vector<int>>& cycles, size_t limit);
+  void unblock(int state, std::vector<bool>& blocked, std::vector<std::set<int>>& blockedMap);
+  std::map<StateSch, std::set<Symbol>> getCycleClosingStates(set<StateSch>& slignore, DelayMap<StateSch>& dmap, double w, delayVersion version, Stat *stats,
+    size_t budget);
 
 };
 
@@ -0,0 +1,191 @@
+#ifndef _MACROSTATE_INDEX_H_
+#define _MACROSTATE_INDEX_H_
+
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include "../Automata/BuchiAutomaton.h"
+#include "BitMacrostate.h"
+#include "StateSch.h"
+
+typedef std::set<int> DFAState;
+
+/*
+ * Macrostates of the waiting part (S-sets) interned to dense ids. Data of the
+ * macrostates (rank bounds, maximum reachable sizes) are kept in flat tables
+ * indexed by the ids; the successor of a macrostate is a table lookup. Rank
+ * bounds can be evaluated on demand (the first time they are asked for).
+ */
+class MacrostateIndex
+{
+private:
+  typedef BitMacrostate<0> Macro;
+
+  size_t words;
+  int symbols;
+  std::unordered_map<Macro, int, BitMacrostateHash<Macro>> ids;
+  std::vector<DFAState> macros;
+  std::vector<int> succ;
+
+  // on-demand evaluation of rank bounds (evaluations are serialized)
+  struct LazyBound
+  {
+    std::function<void(int)> eval;
+    std::mutex mtx;
+    std::vector<std::atomic<bool>> known;
+  };
+  std::shared_ptr<LazyBound> lazy;
+
+public:
+  // rank bound and maximum reachable size of each macrostate
+  std::vector<int> rankBound;
+  std::vector<int> maxReach;
+
+  MacrostateIndex() : words(0), symbols(0), ids(), macros(), succ(), lazy(), rankBound(), maxReach() { }
+
+  /*
+   * Intern all macrostates of the waiting part and their transitions.
+   * @param comp Waiting part (deterministic)
+   * @param states Number of states of the original automaton
+   * @param symbols Number of symbols (all symbols are smaller)
+   */
+  void build(BuchiAutomaton<StateSch, int>& comp, int states, int symbols)
+  {
+    this->words = (states + 63) / 64;
+    this->symbols = symbols;
+    this->ids.clear();
+    this->macros.clear();
+    for(const StateSch& st : comp.getStates())
+      this->insert(st.S);
+    this->succ.assign(this->macros.size()*symbols, -1);
+    for(const auto& tr : comp.getTransitions())
+    {
+      if(tr.second.empty())
+        continue;
+      int src = this->find(tr.first.first.S);
+      this->succ[(size_t)src*symbols + tr.first.second] = this->find(tr.second.begin()->S);
+    }
+    this->rankBound.assign(this->macros.size(), 0);
+    this->maxReach.assign(this->macros.size(), 0);
+    this->lazy.reset();
+  }
+
+  /*
+   * Evaluate rank bounds on demand. The evaluation function is called (under
+   * a lock) for a macrostate whose rank bound is not known yet; it has to
+   * store the bound of the macrostate (and possibly of other macrostates) by
+   * setRankBound.
+   * @param eval Evaluation function taking the id of a macrostate
+   */
+  void setRankBoundEval(const std::function<void(int)>& eval)
+  {
+    this->lazy = std::make_shared<LazyBound>();
+    this->lazy->eval = eval;
+    this->lazy->known = std::vector<std::atomic<bool>>(this->macros.size());
+  }
+
+  /*
+   * Store the rank bound of a macrostate
+   * @param id Id of the macrostate
+   * @param bound Rank bound
+   */
+  void setRankBound(int id, int bound)
+  {
+    this->rankBound[id] = bound;
+    if(this->lazy)
+      this->lazy->known[id].store(true, std::memory_order_release);
+  }
+
+  /*
+   * Is the rank bound of a macrostate known (always true without on-demand
+   * evaluation)
+   */
+  bool hasRankBound(int id) const
+  {
+    return !this->lazy || this->lazy->known[id].load(std::memory_order_acquire);
+  }
+
+  /*
+   * Intern a macrostate (if not present)
+   * @param st Macrostate
+   * @return Id of the macrostate
+   */
+  int insert(const DFAState& st)
+  {
+    auto ins = this->ids.insert({BitSet::fromSet<Macro>(st, this->words), (int)this->macros.size()});
+    if(ins.second)
+      this->macros.push_back(st);
+    return ins.first->second;
+  }
+
+  /*
+   * Find a macrostate
+   * @param st Macrostate
+   * @return Id of the macrostate (-1 if not present)
+   */
+  int find(const DFAState& st) const
+  {
+    for(int s : st)
+    {
+      if(s >= (int)(this->words*64))
+        return -1;
+    }
+    auto it = this->ids.find(BitSet::fromSet<Macro>(st, this->words));
+    return it == this->ids.end() ? -1 : it->second;
+  }
+
+  /*
+   * Successor of a macrostate
+   * @param id Id of the macrostate
+   * @param symbol Symbol
+   * @return Id of the successor (-1 if there is none)
+   */
+  int post(int id, int symbol) const
+  {
+    if(id < 0 || symbol < 0 || symbol >= this->symbols)
+      return -1;
+    return this->succ[(size_t)id*this->symbols + symbol];
+  }
+
+  /*
+   * Rank bound of a macrostate (0 for unknown macrostates), evaluated if
+   * necessary
+   */
+  int getRankBound(int id) const
+  {
+    if(id < 0)
+      return 0;
+    if(!this->hasRankBound(id))
+    {
+      std::lock_guard<std::mutex> lock(this->lazy->mtx);
+      if(!this->hasRankBound(id))
+        this->lazy->eval(id);
+    }
+    return this->rankBound[id];
+  }
+
+  /*
+   * Maximum reachable size of a macrostate (0 for unknown macrostates)
+   */
+  int getMaxReach(int id) const
+  {
+    return id < 0 ? 0 : this->maxReach[id];
+  }
+
+  const DFAState& get(int id) const
+  {
+    return this->macros[id];
+  }
+
+  size_t size() const
+  {
+    return this->macros.size();
+  }
+};
+
+#endif
@@ -2,6 +2,8 @@
 #ifndef _COMPL_OPT_H_
 #define _COMPL_OPT_H_
 
+#include <cstddef>
+
 struct ComplOptions
 {
   bool cutPoint = false;
@@ -10,10 +12,24 @@ struct ComplOptions
   unsigned ROMinState = 9;
   int ROMinRank = 7;
 
+  // limits of macrostates whose tight successors are checked for existence
+  // (and cached). The limits bound the cost of the check, which grows
+  // quickly with the size of the S-set and the rank; the memory of the
+  // cache is bounded by CacheMaxBytes.
   unsigned CacheMaxState = 6;
   int CacheMaxRank = 8;
+  // memory budget of the successor caches (shared by all threads)
+  size_t CacheMaxBytes = 64 << 20;
 
   bool semidetOpt = false;
+  // merge tight macrostates with the same acceptance and transitions
+  bool mergeTight = false;
+
+  // maximum number of cycles enumerated in a single SCC by the delay
+  // optimization (0 = unlimited)
+  size_t delayCycleBudget = 100000;
+
+  unsigned threads = 1;
 };
 
 #endif
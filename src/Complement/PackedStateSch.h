@@ -0,0 +1,185 @@
+#ifndef _PACKED_STATE_SCH_H_
+#define _PACKED_STATE_SCH_H_
+
+#include <set>
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "StateSch.h"
+
+/*
+ * Compact canonical encoding of a state of the Schewe construction. The data
+ * consists of a header word (tight flag, rank width, max rank, i) followed by
+ * the S-set as a bitset, the O-set as a bitset and the ranks of the states of
+ * S in ascending order of states (8 or 16 bits per rank).
+ */
+struct PackedStateSch
+{
+  std::vector<uint64_t> data;
+  uint64_t hash;
+
+  bool operator==(const PackedStateSch& other) const
+  {
+    return this->hash == other.hash && this->data == other.data;
+  }
+
+  bool operator!=(const PackedStateSch& other) const
+  {
+    return !(*this == other);
+  }
+
+  bool operator<(const PackedStateSch& other) const
+  {
+    if(this->hash != other.hash)
+      return this->hash < other.hash;
+    return this->data < other.data;
+  }
+
+  bool isTight() const
+  {
+    return this->data[0] & 1;
+  }
+};
+
+/*
+ * Hash functor for packed states
+ */
+struct PackedStateSchHash
+{
+  size_t operator()(const PackedStateSch& st) const
+  {
+    return st.hash;
+  }
+
+  size_t operator()(const std::pair<PackedStateSch, int>& pr) const
+  {
+    return pr.first.hash ^ (std::hash<int>()(pr.second) * 0x9e3779b97f4a7c15ULL);
+  }
+};
+
+/*
+ * Encoder/decoder between StateSch and PackedStateSch for a fixed number of
+ * states of the original automaton. Rank functions of tight states are
+ * assumed to be defined exactly on the S-set.
+ */
+class StateSchCodec
+{
+private:
+  size_t words;
+  bool useInverse;
+
+  static const uint64_t TIGHT = 1;
+  static const uint64_t WIDE = 2;
+
+  /*
+   * Hash of the encoded data
+   */
+  static uint64_t hashData(const std::vector<uint64_t>& data)
+  {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for(uint64_t w : data)
+    {
+      h ^= w;
+      h *= 0x100000001b3ULL;
+      h ^= h >> 29;
+    }
+    return h;
+  }
+
+  void setBits(std::vector<uint64_t>& data, size_t offset, const std::set<int>& st) const
+  {
+    for(int s : st)
+      data[offset + (s >> 6)] |= uint64_t(1) << (s & 63);
+  }
+
+  std::set<int> getBits(const std::vector<uint64_t>& data, size_t offset) const
+  {
+    std::set<int> ret;
+    for(size_t i = 0; i < this->words; i++)
+    {
+      uint64_t w = data[offset + i];
+      while(w != 0)
+      {
+        ret.insert(ret.end(), int(i*64 + __builtin_ctzll(w)));
+        w &= w - 1;
+      }
+    }
+    return ret;
+  }
+
+public:
+  StateSchCodec() : words(0), useInverse(false) { }
+
+  /*
+   * @param states Number of states (all states of macrostates are smaller)
+   * @param useInverse Build rank functions with the inverse mapping
+   */
+  StateSchCodec(int states, bool useInverse) : words((states + 63) / 64), useInverse(useInverse) { }
+
+  /*
+   * Encode a macrostate
+   * @param st Macrostate
+   * @return Packed macrostate
+   */
+  PackedStateSch encode(const StateSch& st) const
+  {
+    PackedStateSch ret;
+    if(!st.tight)
+    {
+      ret.data.assign(1 + this->words, 0);
+      setBits(ret.data, 1, st.S);
+    }
+    else
+    {
+      int maxRank = st.f.getMaxRank();
+      unsigned width = maxRank > 255 ? 16 : 8;
+      unsigned perWord = 64 / width;
+      size_t rankWords = (st.S.size() + perWord - 1) / perWord;
+      ret.data.assign(1 + 2*this->words + rankWords, 0);
+      ret.data[0] = TIGHT | (width == 16 ? WIDE : 0) | (uint64_t(uint32_t(maxRank) & 0xffffff) << 8) |
+        (uint64_t(uint32_t(st.i)) << 32);
+      setBits(ret.data, 1, st.S);
+      setBits(ret.data, 1 + this->words, st.O);
+
+      size_t base = 1 + 2*this->words;
+      size_t ind = 0;
+      for(const auto& pr : st.f)
+      {
+        ret.data[base + ind / perWord] |= uint64_t(pr.second) << ((ind % perWord) * width);
+        ind++;
+      }
+    }
+    ret.hash = hashData(ret.data);
+    return ret;
+  }
+
+  /*
+   * Decode a macrostate
+   * @param pst Packed macrostate
+   * @return Macrostate
+   */
+  StateSch decode(const PackedStateSch& pst) const
+  {
+    std::set<int> S = getBits(pst.data, 1);
+    if(!pst.isTight())
+      return {S, std::set<int>(), RankFunc(), 0, false};
+
+    unsigned width = (pst.data[0] & WIDE) ? 16 : 8;
+    unsigned perWord = 64 / width;
+    uint64_t mask = (uint64_t(1) << width) - 1;
+    size_t base = 1 + 2*this->words;
+    size_t ind = 0;
+    std::map<int, int> ranks;
+    for(int s : S)
+    {
+      ranks.insert(ranks.end(), {s, int((pst.data[base + ind / perWord] >> ((ind % perWord) * width)) & mask)});
+      ind++;
+    }
+    return {S, getBits(pst.data, 1 + this->words), RankFunc(ranks, this->useInverse),
+      int(uint32_t(pst.data[0] >> 32)), true};
+  }
+};
+
+#endif
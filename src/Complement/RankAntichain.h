@@ -0,0 +1,172 @@
+#ifndef _RANK_ANTICHAIN_H_
+#define _RANK_ANTICHAIN_H_
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+
+#include "RankFunc.h"
+
+/*
+ * Rank vector of a ranking function with the sum of ranks and a monotone bit
+ * signature (a bit is set iff a rank of the corresponding states is in the
+ * upper half; f <= g implies that sig(f) is a subset of sig(g)).
+ */
+struct PackedRank
+{
+  std::vector<int> ranks;
+  long sum;
+  uint64_t sig;
+
+  static PackedRank fromRank(const RankFunc& f)
+  {
+    PackedRank ret = { f.getRanks(), 0, 0 };
+    for(size_t k = 0; k < ret.ranks.size(); k++)
+    {
+      ret.sum += ret.ranks[k];
+      if(2*ret.ranks[k] > f.getMaxRank())
+        ret.sig |= uint64_t(1) << (k % 64);
+    }
+    return ret;
+  }
+
+  /*
+   * Is the rank vector pointwise smaller or equal to another one
+   */
+  bool leq(const PackedRank& other) const
+  {
+    if(this->ranks.size() != other.ranks.size() || this->sum > other.sum || (this->sig & ~other.sig) != 0)
+      return false;
+    for(size_t k = 0; k < this->ranks.size(); k++)
+    {
+      if(this->ranks[k] > other.ranks[k])
+        return false;
+    }
+    return true;
+  }
+
+  static bool lessSum(const PackedRank& a, const PackedRank& b)
+  {
+    return a.sum < b.sum;
+  }
+};
+
+
+/*
+ * Filter of pointwise maximal ranking functions (among the ranking functions
+ * with the same maximum rank). Candidates are bucketed by the maximum rank
+ * and sorted by the sum of ranks; a candidate can be dominated only by
+ * a maximal element with a greater sum. Comparisons of the packed rank
+ * vectors are prefiltered by monotone bit signatures.
+ */
+class RankAntichain
+{
+private:
+  std::vector<RankFunc> funcs;
+  std::vector<int> ranks;
+  std::vector<size_t> offset;
+  std::vector<long> sum;
+  std::vector<uint64_t> sig;
+  // candidates with the same maximum rank and number of states
+  std::map<std::pair<int, size_t>, std::vector<size_t>> buckets;
+
+  bool leq(size_t i, size_t j, size_t len) const
+  {
+    const int* a = this->ranks.data() + this->offset[i];
+    const int* b = this->ranks.data() + this->offset[j];
+    for(size_t k = 0; k < len; k++)
+    {
+      if(a[k] > b[k])
+        return false;
+    }
+    return true;
+  }
+
+public:
+  RankAntichain() : funcs(), ranks(), offset(), sum(), sig(), buckets() { }
+
+  /*
+   * Add a candidate ranking function
+   * @param f Ranking function
+   */
+  void insert(const RankFunc& f)
+  {
+    size_t id = this->funcs.size();
+    const vector<int>& rnk = f.getRanks();
+    long s = 0;
+    uint64_t bits = 0;
+    // bit is set iff a rank of the corresponding states is in the upper half
+    // (r <= r' implies sig(r) is a subset of sig(r'))
+    for(size_t k = 0; k < rnk.size(); k++)
+    {
+      s += rnk[k];
+      if(2*rnk[k] > f.getMaxRank())
+        bits |= uint64_t(1) << (k % 64);
+    }
+    this->offset.push_back(this->ranks.size());
+    this->ranks.insert(this->ranks.end(), rnk.begin(), rnk.end());
+    this->sum.push_back(s);
+    this->sig.push_back(bits);
+    this->buckets[{f.getMaxRank(), rnk.size()}].push_back(id);
+    this->funcs.push_back(f);
+  }
+
+  /*
+   * Get the maximal ranking functions
+   * @return Ranking functions not dominated by a different candidate with
+   *   the same maximum rank (in the order of insertion)
+   */
+  std::vector<RankFunc> getMaximal() const
+  {
+    std::vector<bool> keep(this->funcs.size(), false);
+    for(const auto& bucket : this->buckets)
+    {
+      size_t len = bucket.first.second;
+      std::vector<size_t> order(bucket.second);
+      std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return this->sum[a] > this->sum[b];
+      });
+
+      std::vector<size_t> maximal;
+      for(size_t i : order)
+      {
+        bool dominated = false;
+        for(size_t m : maximal)
+        {
+          // a function with the same sum is either equal or incomparable
+          if(this->sum[m] <= this->sum[i])
+            break;
+          if((this->sig[i] & ~this->sig[m]) != 0)
+            continue;
+          if(this->leq(i, m, len))
+          {
+            dominated = true;
+            break;
+          }
+        }
+        if(!dominated)
+        {
+          maximal.push_back(i);
+          keep[i] = true;
+        }
+      }
+    }
+
+    std::vector<RankFunc> ret;
+    for(size_t i = 0; i < this->funcs.size(); i++)
+    {
+      if(keep[i])
+        ret.push_back(this->funcs[i]);
+    }
+    return ret;
+  }
+
+  size_t size() const
+  {
+    return this->funcs.size();
+  }
+};
+
+#endif
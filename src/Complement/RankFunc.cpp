@@ -74,160 +74,218 @@ void RankFunc::addPair(const std::pair<int, int>& val, bool useInverse)
 
 
 /*
- * Cartesian product of a set of ranking functions and pairs to be added
- * @param s1 Set of ranking funtions
- * @param s2 Vector of pairs to be added to s1
- * @param rem Number of remaining tight positions
- * @param rel Direct simulation
- * @param oddRel Rank simulation
- * @param reachRes Reachability restriction (SuccRank)
- * @param maxReach Maximum reachable macrostate
- * @return Set of combinations of ranking functions with joined pairs
+ * Depth-first search over a restriction of ranking functions. The partial
+ * ranking function is kept in flat arrays that are extended in place and
+ * restored on backtracking, so the memory is linear in the number of states.
+ * Each complete tight ranking function is passed to a visitor.
  */
-vector<RankFunc> RankFunc::cartTightProductMap(vector<RankFunc>& s1, vector<std::pair<int, int> >& s2,
-    int rem, BackRel& rel, BackRel& oddRel, int max, map<int, int>& reachRes, int reachMax, bool useInverse)
+class TightRankSearch
 {
-  vector<RankFunc> ret;
-  int maxRank;
-  for(const auto& v1 : s1)
+private:
+  const RankConstr& slist;
+  BackRel& rel;
+  BackRel& oddRel;
+  int max;
+  const vector<int>& reachRes;
+  int reachMax;
+  bool useInverse;
+  bool checkDirect;
+  bool oddOnly;
+  const RankVisitor& visit;
+
+  // rank of each state (-1 if unassigned) and number of states having a given odd rank
+  vector<int> rank;
+  vector<int> oddCount;
+  int oddDistinct;
+  // assigned pairs and the maximum rank and reachability restriction of each prefix
+  vector<std::pair<int, int>> assigned;
+  vector<int> maxRank;
+  vector<int> reachRest;
+  // states completed by the odd version
+  set<int> states;
+
+  void push(const std::pair<int, int>& p)
   {
-    for(const auto& v2 : s2)
-    {
-      RankFunc tmp(v1);
-      tmp.addPair(v2, useInverse);
-      if(rem < tmp.remTightCount())
-        continue;
-      if(max != -1 && rem == 0 && tmp.getMaxRank() != max)
-        continue;
+    this->rank[p.first] = p.second;
+    if(p.second % 2 != 0 && this->oddCount[(p.second - 1) / 2]++ == 0)
+      this->oddDistinct++;
+    int reach = p.second + 2*(this->reachMax - (p.first < (int)this->reachRes.size() ? this->reachRes[p.first] : 0));
+    this->maxRank.push_back(this->assigned.empty() ? p.second : std::max(this->maxRank.back(), p.second));
+    this->reachRest.push_back(this->assigned.empty() ? reach : std::min(this->reachRest.back(), reach));
+    this->assigned.push_back(p);
+  }
 
-      maxRank = std::min(tmp.getReachRestr(), v2.second + 2*(reachMax - reachRes[v2.first]));
-      if(maxRank < tmp.getMaxRank())
-        continue;
-      tmp.setReachRestr(maxRank);
+  void pop()
+  {
+    const std::pair<int, int>& p = this->assigned.back();
+    this->rank[p.first] = -1;
+    if(p.second % 2 != 0 && --this->oddCount[(p.second - 1) / 2] == 0)
+      this->oddDistinct--;
+    this->assigned.pop_back();
+    this->maxRank.pop_back();
+    this->reachRest.pop_back();
+  }
 
-      // if(!RankFunc::checkDirectBackRel(v2, tmp, rel))
-      //   continue;
-      if(!RankFunc::checkOddBackRel(v2, tmp, oddRel))
+  /*
+   * Check the ranks of the already assigned states wrt a simulation
+   * @param p Last assigned pair
+   * @param r Simulation (pairs of states with the direction of the restriction)
+   * @param oddOnlyRel Consider only states with odd ranks (rank simulation)
+   */
+  bool checkBackRel(const std::pair<int, int>& p, BackRel& r, bool oddOnlyRel) const
+  {
+    if(p.first >= (int)r.size())
+      return true;
+    for(const auto& st : r[p.first])
+    {
+      int act = st.first < (int)this->rank.size() ? this->rank[st.first] : -1;
+      if(act < 0 || (oddOnlyRel && act % 2 == 0))
         continue;
-      ret.push_back(tmp);
+      if((st.second && act < p.second) || (!st.second && act > p.second))
+        return false;
     }
+    return true;
   }
-  return ret;
-}
 
+  /*
+   * Can the last assigned pair be extended to a tight ranking function
+   * @param p Last assigned pair
+   * @param rem Number of remaining states
+   */
+  bool valid(const std::pair<int, int>& p, int rem) const
+  {
+    int mx = this->maxRank.back();
+    int top = mx % 2 == 0 ? mx + 1 : mx;
+    if(rem < (top - 1) / 2 + 1 - this->oddDistinct)
+      return false;
+    if(this->max != -1 && rem == 0 && mx != this->max)
+      return false;
+    if(this->reachRest.back() < mx)
+      return false;
+    if(this->checkDirect && !this->checkBackRel(p, this->rel, false))
+      return false;
+    if(p.second % 2 != 0 && !this->checkBackRel(p, this->oddRel, true))
+      return false;
+    return true;
+  }
 
-/*
- * Cartesian product of a set of ranking functions and pairs to be added (odd variant)
- * @param s1 Set of ranking funtions
- * @param s2 Vector of pairs to be added to s1
- * @param rem Number of remaining tight positions
- * @param rel Direct simulation
- * @param oddRel Rank simulation
- * @param max Maximum rank
- * @param reachRes Reachability restriction (SuccRank)
- * @param maxReach Maximum reachable macrostate
- * @param useInverse Use inverse function
- * @return Set of combinations of ranking functions with joined pairs
- */
-vector<RankFunc> RankFunc::cartTightProductMapOdd(vector<RankFunc>& s1, vector<std::pair<int, int> >& s2,
-    int rem, BackRel& rel, BackRel& oddRel, int max, map<int, int>& reachRes, int reachMax, bool useInverse)
-{
-  vector<RankFunc> ret;
-  int maxRank;
-  bool ins;
-  for(const auto& v1 : s1)
+  /*
+   * Build the ranking function from the assigned pairs and pass it to the visitor
+   * @param complete Apply the final filter and completion of the odd version
+   * @return Continue the search
+   */
+  bool emit(bool complete)
   {
-    ins = false;
-    for(const auto& v2 : s2)
+    RankFunc ret;
+    for(const auto& p : this->assigned)
+      ret.addPair(p, this->useInverse);
+    ret.setReachRestr(this->reachRest.back());
+    if(complete && this->oddOnly)
     {
-      if(v2.second % 2 == 0)
+      if(ret.getMaxRank() % 2 == 0 || ret.remTightCount() != 0)
+        return true;
+      set<int> odd(ret.getOddStates());
+      for(int s : this->states)
       {
-        if(!ins)
-          ret.push_back(v1);
-        ins = true;
-        continue;
+        if(odd.find(s) == odd.end())
+          ret.addPair({s, ret.getMaxRank() - 1}, this->useInverse);
       }
-      RankFunc tmp(v1);
-      tmp.addPair(v2, useInverse);
-      if(rem < tmp.remTightCount())
-        continue;
-      if(max != -1 && rem == 0 && tmp.getMaxRank() != max)
-        continue;
-
-      maxRank = std::min(tmp.getReachRestr(), v2.second + 2*(reachMax - reachRes[v2.first]));
-      if(maxRank < tmp.getMaxRank())
-        continue;
-      tmp.setReachRestr(maxRank);
-
-      if(!RankFunc::checkDirectBackRel(v2, tmp, rel))
-        continue;
-      if(!RankFunc::checkOddBackRel(v2, tmp, oddRel))
-        continue;
-      ret.push_back(tmp);
     }
+    return this->visit(ret);
   }
-  return ret;
-}
 
-
-/*
- * Check if combination or tmp with joined act fulfills direct simulation restr
- * @param act Pair
- * @param tmp Ranking function
- * @param rel Direct simulation
- * @return DirSim Compatibility
- */
-bool RankFunc::checkDirectBackRel(const std::pair<int, int>& act, const RankFunc& tmp, BackRel& rel)
-{
-  for(auto st : rel[act.first])
+public:
+  TightRankSearch(const RankConstr& slist, BackRel& rel, BackRel& oddRel, int max,
+      const vector<int>& reachRes, int reachMax, bool useInverse, bool checkDirect,
+      bool oddOnly, const RankVisitor& visit) : slist(slist), rel(rel), oddRel(oddRel),
+      max(max), reachRes(reachRes), reachMax(reachMax), useInverse(useInverse),
+      checkDirect(checkDirect), oddOnly(oddOnly), visit(visit), rank(), oddCount(),
+      oddDistinct(0), assigned(), maxRank(), reachRest(), states()
   {
-    auto it = tmp.find(st.first);
-    if(it != tmp.end())
+    int size = 0;
+    int maxConstr = 0;
+    for(unsigned i = 0; i < slist.size(); i++)
     {
-      if(st.second && it->second < act.second)
+      for(const auto& p : slist[i])
       {
-        return false;
+        size = std::max(size, p.first + 1);
+        maxConstr = std::max(maxConstr, p.second);
       }
-      if(!st.second && it->second > act.second)
+      if(i == 0)
       {
-        return false;
+        for(const auto& p : slist[i])
+          this->states.insert(p.first);
       }
+      else if(slist[i].size() > 0)
+        this->states.insert(slist[i][0].first);
     }
+    this->rank.assign(size, -1);
+    this->oddCount.assign(maxConstr / 2 + 1, 0);
   }
-  return true;
-}
-
 
-/*
- * Check if combination or tmp with joined act fulfills rank simulation restr
- * @param act Pair
- * @param tmp Ranking function
- * @param oddRel Direct simulation
- * @return RankSim Compatibility
- */
-bool RankFunc::checkOddBackRel(const std::pair<int, int>& act, const RankFunc& tmp, BackRel& oddRel)
-{
-  if(act.second % 2 != 0)
+  /*
+   * Search from a given depth (index to the restriction)
+   * @param d Depth
+   * @return Continue the search (false if stopped by the visitor)
+   */
+  bool search(unsigned d)
   {
-    for(auto st : oddRel[act.first])
+    if(d == this->slist.size())
+      return this->emit(true);
+    // the odd version returns the partial ranking functions if a restriction is empty
+    if(this->oddOnly && d > 0 && this->slist[d].size() == 0)
+      return this->emit(false);
+
+    bool skipped = false;
+    for(const auto& p : this->slist[d])
     {
-      auto it = tmp.find(st.first);
-      if(it != tmp.end())
+      // the odd version leaves states with even ranks unassigned (added in the completion)
+      if(this->oddOnly && d > 0 && p.second % 2 == 0)
       {
-        if(it->second % 2 == 0)
+        if(skipped)
           continue;
-        if(st.second && it->second < act.second)
-        {
+        skipped = true;
+        if(!this->search(d + 1))
           return false;
-        }
-        if(!st.second && it->second > act.second)
-        {
-          return false;
-        }
+        continue;
       }
+
+      this->push(p);
+      bool cont = true;
+      if(d == 0 || this->valid(p, this->slist.size() - d - 1))
+        cont = this->search(d + 1);
+      this->pop();
+      if(!cont)
+        return false;
     }
+    return true;
   }
-  return true;
+};
+
+
+/*
+ * Enumerate tight ranking functions based on restriction slist
+ * @param slist Restriction of ranking functions
+ * @param rel Direct simulation
+ * @param oddRel Rank simulation
+ * @param max Maximum rank (-1 if not restricted)
+ * @param reachRes Reachability restriction (SuccRank)
+ * @param reachMax Maximum reachable macrostate
+ * @param useInverse Use inverse function
+ * @param checkDirect Check the direct simulation
+ * @param oddOnly Odd version (only odd ranks are enumerated)
+ * @param visit Visitor of the ranking functions (returns false to stop)
+ * @return Is the enumeration complete (not stopped by the visitor)?
+ */
+bool RankFunc::tightRankSearch(const RankConstr& slist, BackRel& rel, BackRel& oddRel, int max,
+    const vector<int>& reachRes, int reachMax, bool useInverse, bool checkDirect, bool oddOnly,
+    const RankVisitor& visit)
+{
+  if(slist.size() == 0)
+    return true;
+  TightRankSearch search(slist, rel, oddRel, max, reachRes, reachMax, useInverse, checkDirect,
+    oddOnly, visit);
+  return search.search(0);
 }
 
 
@@ -243,23 +301,11 @@ bool RankFunc::checkOddBackRel(const std::pair<int, int>& act, const RankFunc& t
  * @return Set of all ranking functions
  */
 vector<RankFunc> RankFunc::cartTightProductMapList(RankConstr slist, BackRel& rel, BackRel& oddRel,
-    int max, map<int, int>& reachRes, int reachMax, bool useInverse)
+    int max, const vector<int>& reachRes, int reachMax, bool useInverse)
 {
   vector<RankFunc> ret;
-  if(slist.size() == 0)
-    return ret;
-
-  for(auto p : slist[0])
-  {
-    RankFunc sing(map<int, int>({p}), useInverse);
-    sing.setReachRestr(p.second + 2*(reachMax - reachRes[p.first]));
-    ret.push_back(sing);
-  }
-  for(int i = 1; i < (int)slist.size(); i++)
-  {
-    ret = RankFunc::cartTightProductMap(ret, slist[i], slist.size() - i - 1, rel, oddRel,
-      max, reachRes, reachMax, useInverse);
-  }
+  RankFunc::tightRankSearch(slist, rel, oddRel, max, reachRes, reachMax, useInverse, false, false,
+    [&ret](RankFunc& r) { ret.push_back(std::move(r)); return true; });
   return ret;
 }
 
@@ -276,47 +322,12 @@ vector<RankFunc> RankFunc::cartTightProductMapList(RankConstr slist, BackRel& re
  * @return Set of all ranking functions
  */
 vector<RankFunc> RankFunc::cartTightProductMapListOdd(RankConstr slist, BackRel& rel, BackRel& oddRel,
-    int max, map<int, int>& reachRes, int reachMax, bool useInverse)
+    int max, const vector<int>& reachRes, int reachMax, bool useInverse)
 {
   vector<RankFunc> ret;
-  vector<RankFunc> retcp;
-  if(slist.size() == 0)
-    return ret;
-  set<int> states;
-
-  for(auto p : slist[0])
-  {
-    RankFunc sing(map<int, int>({p}), useInverse);
-    sing.setReachRestr(p.second + 2*(reachMax - reachRes[p.first]));
-    ret.push_back(sing);
-    states.insert(p.first);
-  }
-  for(int i = 1; i < (int)slist.size(); i++)
-  {
-    if(slist[i].size() == 0)
-      return ret;
-    ret = RankFunc::cartTightProductMapOdd(ret, slist[i], slist.size() - i - 1, rel, oddRel, max,
-      reachRes, reachMax, useInverse);
-    states.insert(slist[i][0].first);
-    //std::cout << i << " : " << ret.size() << std::endl;
-  }
-
-  for(unsigned i = 0; i < ret.size(); i++)
-  {
-    if(ret[i].getMaxRank() % 2 == 0 || ret[i].remTightCount() != 0)
-      continue;
-    auto odd(ret[i].getOddStates());
-    for(int s : states)
-    {
-      if(odd.find(s) == odd.end())
-      {
-        ret[i].addPair({s, ret[i].getMaxRank() - 1}, useInverse);
-      }
-    }
-    retcp.push_back(ret[i]);
-  }
-
-  return retcp;
+  RankFunc::tightRankSearch(slist, rel, oddRel, max, reachRes, reachMax, useInverse, true, true,
+    [&ret](RankFunc& r) { ret.push_back(std::move(r)); return true; });
+  return ret;
 }
 
 
@@ -328,8 +339,8 @@ vector<RankFunc> RankFunc::cartTightProductMapListOdd(RankConstr slist, BackRel&
 vector<RankFunc> RankFunc::fromRankConstr(RankConstr constr)
 {
   vector<vector<std::pair<int,bool> > > emp;
-  map<int, int> empMap;
-  return RankFunc::cartTightProductMapList(constr, emp, emp, -1, empMap, INF, false);
+  vector<int> empReach;
+  return RankFunc::cartTightProductMapList(constr, emp, emp, -1, empReach, INF, false);
 }
 
 
@@ -344,12 +355,30 @@ vector<RankFunc> RankFunc::fromRankConstr(RankConstr constr)
  * @return Set of all tight ranking functions
  */
 vector<RankFunc> RankFunc::tightFromRankConstr(RankConstr constr, BackRel& rel, BackRel& oddRel,
-    map<int, int>& reachRes, int reachMax, bool useInverse)
+    const vector<int>& reachRes, int reachMax, bool useInverse)
 {
   return RankFunc::cartTightProductMapList(constr, rel, oddRel, -1, reachRes, reachMax, useInverse);
 }
 
 
+/*
+ * Enumerate all tight ranking functions based on restriction (no max rank,
+ * tight start) without storing them
+ * @param constr Restriction of ranking functions
+ * @param rel Direct simulation
+ * @param oddRel Rank simulation
+ * @param reachRes Reachability restriction (SuccRank)
+ * @param reachMax Maximum reachable macrostate
+ * @param useInverse Use inverse function
+ * @param visit Visitor of the ranking functions (returns false to stop)
+ */
+void RankFunc::tightFromRankConstr(const RankConstr& constr, BackRel& rel, BackRel& oddRel,
+    const vector<int>& reachRes, int reachMax, bool useInverse, const RankVisitor& visit)
+{
+  RankFunc::tightRankSearch(constr, rel, oddRel, -1, reachRes, reachMax, useInverse, false, false, visit);
+}
+
+
 /*
  * Generate all tight ranking functions based on restriction (odd version)
  * @param constr Restriction of ranking functions
@@ -361,7 +390,7 @@ vector<RankFunc> RankFunc::tightFromRankConstr(RankConstr constr, BackRel& rel,
  * @return Set of all tight ranking functions
  */
 vector<RankFunc> RankFunc::tightFromRankConstrOdd(RankConstr constr, BackRel& rel, BackRel& oddRel,
-    map<int, int>& reachRes, int reachMax, bool useInverse)
+    const vector<int>& reachRes, int reachMax, bool useInverse)
 {
   return RankFunc::cartTightProductMapListOdd(constr, rel, oddRel, -1, reachRes, reachMax, useInverse);
 }
@@ -380,12 +409,34 @@ vector<RankFunc> RankFunc::tightFromRankConstrOdd(RankConstr constr, BackRel& re
  * @return Set of all tight ranking functions
  */
 vector<RankFunc> RankFunc::tightSuccFromRankConstr(RankConstr constr, BackRel& rel, BackRel& oddRel,
-    int max, map<int, int>& reachRes, int reachMax, bool useInverse)
+    int max, const vector<int>& reachRes, int reachMax, bool useInverse)
 {
   return RankFunc::cartTightProductMapList(constr, rel, oddRel, max, reachRes, reachMax, useInverse);
 }
 
 
+/*
+ * Is there a tight ranking function fulfilling the restriction (i.e., is the
+ * result of tightSuccFromRankConstr nonempty). The enumeration stops at the
+ * first witness.
+ * @param slist Restriction of ranking functions
+ * @param oddRel Rank simulation
+ * @param max Maximum rank
+ * @param reachRes Reachability restriction (SuccRank)
+ * @param reachMax Maximum reachable macrostate
+ * @return Exists a tight ranking function
+ */
+bool RankFunc::existsTightSuccFromRankConstr(const RankConstr& slist, BackRel& oddRel,
+    int max, const vector<int>& reachRes, int reachMax)
+{
+  BackRel emp;
+  bool found = false;
+  RankFunc::tightRankSearch(slist, emp, oddRel, max, reachRes, reachMax, false, false, false,
+    [&found](RankFunc&) { found = true; return false; });
+  return found;
+}
+
+
 /*
  * does the ranking function fulfills the RankRestr constraint
  * @param prev Ranking function
@@ -625,51 +676,6 @@ vector<RankFunc> RankFunc::getRORanks(int ranks, std::set<int>& states, std::set
 }
 
 
-/*
- * Cartesian product of a set of ranking functions and pairs to be added
- * @param s1 Set of ranking funtions
- * @param s2 Vector of pairs to be added to s1
- * @param rem Number of remaining tight positions
- * @param rel Direct simulation
- * @param oddRel Rank simulation
- * @param max Max rank
- * @param reachRes Reachability restriction (SuccRank)
- * @param reachMax Maximum reachable macrostate
- * @param useInverse Use inverse ranking function
- * @return Set of combinations of ranking functions with joined pairs
- */
-vector<RankFunc> RankFunc::cartTightProductMapPure(vector<RankFunc>& s1, vector<std::pair<int, int> >& s2,
-    int rem, BackRel& rel, BackRel& oddRel, int max, map<int, int>& reachRes, int reachMax, bool useInverse)
-{
-  vector<RankFunc> ret;
-  int maxRank;
-  for(const auto& v1 : s1)
-  {
-    for(const auto& v2 : s2)
-    {
-      RankFunc tmp(v1);
-      tmp.addPair(v2, useInverse);
-      if(rem < tmp.remTightCount())
-        continue;
-      if(max != -1 && rem == 0 && tmp.getMaxRank() != max)
-        continue;
-
-      maxRank = std::min(tmp.getReachRestr(), v2.second + 2*(reachMax - reachRes[v2.first]));
-      if(maxRank < tmp.getMaxRank())
-        continue;
-      tmp.setReachRestr(maxRank);
-
-      if(!RankFunc::checkDirectBackRel(v2, tmp, rel))
-        continue;
-      if(!RankFunc::checkOddBackRel(v2, tmp, oddRel))
-        continue;
-      ret.push_back(tmp);
-    }
-  }
-  return ret;
-}
-
-
 /*
  * Generate all ranking functions based on restriction slist (pure version)
  * @param slist Restriction of ranking functions
@@ -682,23 +688,11 @@ vector<RankFunc> RankFunc::cartTightProductMapPure(vector<RankFunc>& s1, vector<
  * @return Set of all ranking functions
  */
 vector<RankFunc> RankFunc::cartTightProductMapListPure(RankConstr slist, BackRel& rel, BackRel& oddRel,
-    int max, map<int, int>& reachRes, int reachMax, bool useInverse)
+    int max, const vector<int>& reachRes, int reachMax, bool useInverse)
 {
   vector<RankFunc> ret;
-  if(slist.size() == 0)
-    return ret;
-
-  for(auto p : slist[0])
-  {
-    RankFunc sing(map<int, int>({p}), useInverse);
-    sing.setReachRestr(p.second + 2*(reachMax - reachRes[p.first]));
-    ret.push_back(sing);
-  }
-  for(int i = 1; i < (int)slist.size(); i++)
-  {
-    ret = RankFunc::cartTightProductMap(ret, slist[i], slist.size() - i - 1, rel, oddRel,
-      max, reachRes, reachMax, useInverse);
-  }
+  RankFunc::tightRankSearch(slist, rel, oddRel, max, reachRes, reachMax, useInverse, false, false,
+    [&ret](RankFunc& r) { ret.push_back(std::move(r)); return true; });
   return ret;
 }
 
@@ -714,7 +708,7 @@ vector<RankFunc> RankFunc::cartTightProductMapListPure(RankConstr slist, BackRel
  * @return Set of all tight ranking functions
  */
 vector<RankFunc> RankFunc::tightFromRankConstrPure(RankConstr constr, BackRel& rel, BackRel& oddRel,
-    map<int, int>& reachRes, int reachMax, bool useInverse)
+    const vector<int>& reachRes, int reachMax, bool useInverse)
 {
   return RankFunc::cartTightProductMapListPure(constr, rel, oddRel, -1, reachRes, reachMax, useInverse);
 }
@@ -732,7 +726,7 @@ vector<RankFunc> RankFunc::tightFromRankConstrPure(RankConstr constr, BackRel& r
  * @return Set of all tight ranking functions
  */
 vector<RankFunc> RankFunc::tightSuccFromRankConstrPure(RankConstr constr, BackRel& rel, BackRel& oddRel,
-    int max, map<int, int>& reachRes, int reachMax, bool useInverse)
+    int max, const vector<int>& reachRes, int reachMax, bool useInverse)
 {
   return RankFunc::cartTightProductMapListPure(constr, rel, oddRel, max, reachRes, reachMax, useInverse);
 }
@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <functional>
 #include <string>
 #include "../Algorithms/AuxFunctions.h"
 
@@ -24,6 +25,7 @@ class RankFunc;
 typedef vector<vector<std::pair<int, int> > > RankConstr;
 typedef map<int, set<int> > RankInverse;
 typedef vector<vector<std::pair<int,bool> > > BackRel;
+typedef std::function<bool(RankFunc&)> RankVisitor;
 
 /*
  * Ranking function
@@ -40,23 +42,15 @@ private:
   boost::dynamic_bitset<> tight;
   //vector<bool> tight;
 
-  static vector<RankFunc> cartTightProductMap(vector<RankFunc>& s1, vector<std::pair<int, int> >& s2, int rem,
-      BackRel& rel, BackRel& oddRel, int max, map<int, int>& reachRes, int reachMax, bool useInverse);
+  static bool tightRankSearch(const RankConstr& slist, BackRel& rel, BackRel& oddRel, int max,
+      const vector<int>& reachRes, int reachMax, bool useInverse, bool checkDirect, bool oddOnly,
+      const RankVisitor& visit);
   static vector<RankFunc> cartTightProductMapList(RankConstr slist, BackRel& rel, BackRel& oddRel, int max,
-      map<int, int>& reachRes, int reachMax, bool useInverse);
-  static inline bool checkDirectBackRel(const std::pair<int, int>& act, const RankFunc& tmp, BackRel& rel);
-  static inline bool checkOddBackRel(const std::pair<int, int>& act, const RankFunc& tmp, BackRel& oddRel);
-
-  static vector<RankFunc> cartTightProductMapOdd(vector<RankFunc>& s1, vector<std::pair<int, int> >& s2,
-      int rem, BackRel& rel, BackRel& oddRel, int max, map<int, int>& reachRes, int reachMax, bool useInverse);
+      const vector<int>& reachRes, int reachMax, bool useInverse);
   static vector<RankFunc> cartTightProductMapListOdd(RankConstr slist, BackRel& rel, BackRel& oddRel,
-      int max, map<int, int>& reachRes, int reachMax, bool useInverse);
-
-
-  static vector<RankFunc> cartTightProductMapPure(vector<RankFunc>& s1, vector<std::pair<int, int> >& s2, int rem,
-      BackRel& rel, BackRel& oddRel, int max, map<int, int>& reachRes, int reachMax, bool useInverse);
+      int max, const vector<int>& reachRes, int reachMax, bool useInverse);
   static vector<RankFunc> cartTightProductMapListPure(RankConstr slist, BackRel& rel, BackRel& oddRel, int max,
-      map<int, int>& reachRes, int reachMax, bool useInverse);
+      const vector<int>& reachRes, int reachMax, bool useInverse);
 
 
 public:
@@ -121,12 +115,14 @@ public:
   void setReachRestr(int val) { this->reachRest = val; }
 
   static vector<RankFunc> fromRankConstr(RankConstr constr);
-  static vector<RankFunc> tightFromRankConstr(RankConstr constr, BackRel& rel, BackRel& oddRel, map<int, int>& reachRes, int reachMax, bool useInverse);
-  static vector<RankFunc> tightFromRankConstrOdd(RankConstr constr, BackRel& rel, BackRel& oddRel, map<int, int>& reachRes, int reachMax, bool useInverse);
-  static vector<RankFunc> tightSuccFromRankConstr(RankConstr constr, BackRel& rel, BackRel& oddRel, int max, map<int, int>& reachRes, int reachMax, bool useInverse);
-
-  static vector<RankFunc> tightFromRankConstrPure(RankConstr constr, BackRel& rel, BackRel& oddRel, map<int, int>& reachRes, int reachMax, bool useInverse);
-  static vector<RankFunc> tightSuccFromRankConstrPure(RankConstr constr, BackRel& rel, BackRel& oddRel, int max, map<int, int>& reachRes, int reachMax, bool useInverse);
+  static vector<RankFunc> tightFromRankConstr(RankConstr constr, BackRel& rel, BackRel& oddRel, const vector<int>& reachRes, int reachMax, bool useInverse);
+  static void tightFromRankConstr(const RankConstr& constr, BackRel& rel, BackRel& oddRel, const vector<int>& reachRes, int reachMax, bool useInverse, const RankVisitor& visit);
+  static vector<RankFunc> tightFromRankConstrOdd(RankConstr constr, BackRel& rel, BackRel& oddRel, const vector<int>& reachRes, int reachMax, bool useInverse);
+  static vector<RankFunc> tightSuccFromRankConstr(RankConstr constr, BackRel& rel, BackRel& oddRel, int max, const vector<int>& reachRes, int reachMax, bool useInverse);
+  static bool existsTightSuccFromRankConstr(const RankConstr& constr, BackRel& oddRel, int max, const vector<int>& reachRes, int reachMax);
+
+  static vector<RankFunc> tightFromRankConstrPure(RankConstr constr, BackRel& rel, BackRel& oddRel, const vector<int>& reachRes, int reachMax, bool useInverse);
+  static vector<RankFunc> tightSuccFromRankConstrPure(RankConstr constr, BackRel& rel, BackRel& oddRel, int max, const vector<int>& reachRes, int reachMax, bool useInverse);
 
   static vector<RankFunc> getRORanks(int ranks, std::set<int>& states, std::set<int>& fin, bool useInverse);
 };
@@ -0,0 +1,169 @@
+#ifndef _RANKING_COUNTS_H_
+#define _RANKING_COUNTS_H_
+
+#include <vector>
+#include <limits>
+
+#include "../Automata/BuchiAutomaton.h"
+
+/*
+ * Numbers of ranking functions of macrostates used by the delay optimization
+ * (for the old, new/subset and stirling versions). A number of rankings of
+ * a triple (maximum rank, accepting states, nonaccepting states) is the
+ * product of the number of rankings of the nonaccepting states (tabulated
+ * by the maximum rank and the number of nonaccepting states) and the number
+ * of even rankings of the accepting states (tabulated by the number of even
+ * ranks and the number of accepting states). The tables are filled once
+ * using saturating 128-bit arithmetic.
+ */
+class RankingCounts
+{
+public:
+  typedef unsigned __int128 Count;
+
+  static constexpr Count Max = ~Count(0);
+
+  static Count add(Count a, Count b)
+  {
+    return (a > Max - b) ? Max : a + b;
+  }
+
+  static Count mul(Count a, Count b)
+  {
+    return (a != 0 && b > Max / a) ? Max : a * b;
+  }
+
+private:
+  unsigned maxRank;
+  unsigned maxStates;
+  // odd[maxRank][nonAcc], even[evenRanks][acc]
+  std::vector<std::vector<Count>> odd;
+  std::vector<std::vector<Count>> even;
+  std::vector<std::vector<Count>> binom;
+
+  Count nCr(unsigned n, unsigned r) const
+  {
+    return (r > n) ? 0 : this->binom[n][r];
+  }
+
+  /*
+   * Number of ways of assigning all odd ranks 1, 3, ..., 2*k+1 (iterations)
+   * of the original formula: each iteration extends the previous count by
+   * nonempty subsets of the remaining states.
+   */
+  Count oddChain(unsigned nonAcc, unsigned k, unsigned iterations) const
+  {
+    Count tmpSum = 1;
+    Count tmp = 0;
+    unsigned upperBound = nonAcc - k;
+    for(unsigned r = 0; r < iterations; r++)
+    {
+      unsigned innerUpperBound = nonAcc - k + 1 + r;
+      tmp = 0;
+      for(unsigned i = 1; i <= upperBound; i++)
+        tmp = add(tmp, mul(this->nCr(innerUpperBound, i), tmpSum));
+      tmpSum = tmp;
+    }
+    return tmp;
+  }
+
+  Count oldOdd(unsigned rank, unsigned nonAcc) const
+  {
+    unsigned k = (rank - 1)/2;
+    if(rank == 0 || nonAcc < k)
+      return 0;
+    return this->oddChain(nonAcc, k, k + 1);
+  }
+
+  Count newOdd(unsigned rank, unsigned nonAcc) const
+  {
+    Count oddSum = 0;
+    for(unsigned count = 0; count < (rank + 1)/2; count++)
+    {
+      unsigned k = count;
+      if(nonAcc < k)
+        continue;
+      Count odd = (count == 0 && nonAcc > 0) ? 1 : 0;
+      if(k > 0)
+        odd = this->oddChain(nonAcc, k, k);
+      oddSum = add(oddSum, odd);
+    }
+    return oddSum;
+  }
+
+public:
+  /*
+   * Fill the tables
+   * @param version Version of the delay optimization
+   * @param maxRank Maximum rank of the macrostates
+   * @param maxStates Maximum size of the macrostates
+   */
+  RankingCounts(delayVersion version, unsigned maxRank, unsigned maxStates) : maxRank(maxRank),
+    maxStates(maxStates), odd(maxRank + 1, std::vector<Count>(maxStates + 1, 0)),
+    even((maxRank + 1)/2 + 1, std::vector<Count>(maxStates + 1, 0)),
+    binom(maxStates + 2, std::vector<Count>(maxStates + 2, 0))
+  {
+    for(unsigned n = 0; n < this->binom.size(); n++)
+    {
+      this->binom[n][0] = 1;
+      for(unsigned r = 1; r <= n; r++)
+        this->binom[n][r] = add(this->binom[n-1][r-1], this->binom[n-1][r]);
+    }
+
+    for(unsigned e = 0; e < this->even.size(); e++)
+    {
+      this->even[e][0] = 1;
+      for(unsigned acc = 1; acc <= maxStates; acc++)
+        this->even[e][acc] = mul(this->even[e][acc-1], e);
+    }
+
+    if(version == oldVersion)
+    {
+      for(unsigned rank = 0; rank <= maxRank; rank++)
+        for(unsigned nonAcc = 0; nonAcc <= maxStates; nonAcc++)
+          this->odd[rank][nonAcc] = this->oldOdd(rank, nonAcc);
+    }
+    else if(version == newVersion || version == subsetVersion)
+    {
+      for(unsigned rank = 0; rank <= maxRank; rank++)
+        for(unsigned nonAcc = 0; nonAcc <= maxStates; nonAcc++)
+          this->odd[rank][nonAcc] = this->newOdd(rank, nonAcc);
+    }
+    else
+    {
+      // surjections onto t odd ranks: surj(n, t) = t*(surj(n-1, t) + surj(n-1, t-1))
+      unsigned ranks = (maxRank + 1)/2;
+      std::vector<std::vector<Count>> surj(maxStates + 1, std::vector<Count>(ranks + 1, 0));
+      surj[0][0] = 1;
+      for(unsigned n = 1; n <= maxStates; n++)
+        for(unsigned t = 1; t <= ranks; t++)
+          surj[n][t] = mul(t, add(surj[n-1][t], surj[n-1][t-1]));
+      for(unsigned rank = 0; rank <= maxRank; rank++)
+      {
+        for(unsigned nonAcc = 0; nonAcc <= maxStates; nonAcc++)
+        {
+          Count sum = 0;
+          for(unsigned t = 1; t <= (rank + 1)/2; t++)
+            sum = add(sum, surj[nonAcc][t]);
+          this->odd[rank][nonAcc] = sum;
+        }
+      }
+    }
+  }
+
+  /*
+   * Get the number of rankings
+   * @param maxRank Maximum rank
+   * @param accStates Number of accepting states
+   * @param nonAccStates Number of nonaccepting states
+   * @return Number of rankings (saturated)
+   */
+  Count get(unsigned maxRank, unsigned accStates, unsigned nonAccStates) const
+  {
+    if(maxRank > this->maxRank || accStates > this->maxStates || nonAccStates > this->maxStates)
+      return 0;
+    return mul(this->odd[maxRank][nonAccStates], this->even[(maxRank + 1)/2][accStates]);
+  }
+};
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef _STATE_STORE_H_
+#define _STATE_STORE_H_
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "PackedStateSch.h"
+
+/*
+ * Store of packed macrostates assigning dense ids (in the order of insertion).
+ * Lookup is done via an open-addressing hash table (linear probing) of ids.
+ */
+class PackedStateStore
+{
+private:
+  std::vector<PackedStateSch> states;
+  std::vector<int> slots;
+  size_t mask;
+
+  void grow()
+  {
+    size_t cap = this->slots.empty() ? 1024 : this->slots.size() * 2;
+    this->slots.assign(cap, -1);
+    this->mask = cap - 1;
+    for(size_t i = 0; i < this->states.size(); i++)
+    {
+      size_t pos = this->states[i].hash & this->mask;
+      while(this->slots[pos] != -1)
+        pos = (pos + 1) & this->mask;
+      this->slots[pos] = i;
+    }
+  }
+
+public:
+  PackedStateStore() : states(), slots(), mask(0) { }
+
+  /*
+   * Insert a macrostate (if not present)
+   * @param st Packed macrostate
+   * @return Pair (id of the macrostate, was it inserted)
+   */
+  std::pair<int, bool> insert(const PackedStateSch& st)
+  {
+    if((this->states.size() + 1) * 10 > this->slots.size() * 7)
+      grow();
+    size_t pos = st.hash & this->mask;
+    while(this->slots[pos] != -1)
+    {
+      if(this->states[this->slots[pos]] == st)
+        return {this->slots[pos], false};
+      pos = (pos + 1) & this->mask;
+    }
+    int id = this->states.size();
+    this->slots[pos] = id;
+    this->states.push_back(st);
+    return {id, true};
+  }
+
+  /*
+   * Find a macrostate
+   * @param st Packed macrostate
+   * @return Id of the macrostate (-1 if not present)
+   */
+  int find(const PackedStateSch& st) const
+  {
+    if(this->slots.empty())
+      return -1;
+    size_t pos = st.hash & this->mask;
+    while(this->slots[pos] != -1)
+    {
+      if(this->states[this->slots[pos]] == st)
+        return this->slots[pos];
+      pos = (pos + 1) & this->mask;
+    }
+    return -1;
+  }
+
+  /*
+   * Get a macrostate by its id
+   */
+  const PackedStateSch& get(int id) const
+  {
+    return this->states[id];
+  }
+
+  size_t size() const
+  {
+    return this->states.size();
+  }
+
+  void clear()
+  {
+    this->states.clear();
+    this->slots.clear();
+    this->mask = 0;
+  }
+};
+
+/*
+ * Concurrent variant of PackedStateStore. Macrostates are split into shards
+ * (according to the upper bits of the hash), each shard is a PackedStateStore
+ * protected by its own mutex. The id of a macrostate is local*shards + shard,
+ * hence ids are unique but not dense.
+ */
+class ShardedStateStore
+{
+private:
+  struct Shard
+  {
+    std::mutex lock;
+    PackedStateStore store;
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards;
+
+  size_t shardOf(const PackedStateSch& st) const
+  {
+    return (st.hash >> 40) % this->shards.size();
+  }
+
+public:
+  /*
+   * @param shards Number of shards
+   */
+  ShardedStateStore(unsigned shards) : shards()
+  {
+    for(unsigned i = 0; i < shards; i++)
+      this->shards.push_back(std::unique_ptr<Shard>(new Shard()));
+  }
+
+  /*
+   * Insert a macrostate (if not present)
+   * @param st Packed macrostate
+   * @return Pair (id of the macrostate, was it inserted)
+   */
+  std::pair<int, bool> insert(const PackedStateSch& st)
+  {
+    size_t sh = shardOf(st);
+    std::lock_guard<std::mutex> guard(this->shards[sh]->lock);
+    auto ret = this->shards[sh]->store.insert(st);
+    return {ret.first*this->shards.size() + sh, ret.second};
+  }
+
+  /*
+   * Find a macrostate
+   * @param st Packed macrostate
+   * @return Id of the macrostate (-1 if not present)
+   */
+  int find(const PackedStateSch& st)
+  {
+    size_t sh = shardOf(st);
+    std::lock_guard<std::mutex> guard(this->shards[sh]->lock);
+    int id = this->shards[sh]->store.find(st);
+    return id == -1 ? -1 : id*this->shards.size() + sh;
+  }
+
+  /*
+   * Call a function for each pair (id, macrostate). Not synchronized with
+   * concurrent insertions.
+   */
+  template <typename Fnc>
+  void forEach(Fnc fnc) const
+  {
+    for(size_t sh = 0; sh < this->shards.size(); sh++)
+    {
+      const PackedStateStore& store = this->shards[sh]->store;
+      for(size_t i = 0; i < store.size(); i++)
+        fnc(int(i*this->shards.size() + sh), store.get(i));
+    }
+  }
+
+  size_t size() const
+  {
+    size_t ret = 0;
+    for(const auto& sh : this->shards)
+      ret += sh->store.size();
+    return ret;
+  }
+};
+
+#endif
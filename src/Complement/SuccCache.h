@@ -0,0 +1,173 @@
+#ifndef _SUCC_CACHE_H_
+#define _SUCC_CACHE_H_
+
+#include <map>
+#include <list>
+#include <tuple>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "RankFunc.h"
+#include "RankAntichain.h"
+
+/*
+ * Cache of the existence of tight successors keyed by the id of the S-set,
+ * the symbol and the maximum rank. A successor of a smaller ranking function
+ * is a successor of a larger one as well, so each key keeps two antichains:
+ * minimal ranking functions having a successor and maximal ranking functions
+ * without a successor. Entries are sorted by the sum of ranks and prefiltered
+ * by monotone bit signatures. The cache has a memory budget; the least
+ * recently used keys are evicted.
+ */
+class SuccExistCache
+{
+public:
+  typedef std::tuple<int, int, int> Key;
+
+  // default memory budget (in bytes)
+  static const size_t DefaultBudget = 64 << 20;
+
+private:
+  struct Slot
+  {
+    // minimal ranking functions with a successor, maximal ones without
+    // a successor (both sorted by the sum of ranks)
+    std::vector<PackedRank> exists;
+    std::vector<PackedRank> empty;
+    size_t bytes;
+    std::list<Key>::iterator lru;
+  };
+
+  std::map<Key, Slot> slots;
+  std::list<Key> lru;
+  size_t budget;
+  size_t used;
+
+  static size_t entryBytes(const PackedRank& e)
+  {
+    return sizeof(PackedRank) + e.ranks.size()*sizeof(int);
+  }
+
+  void touch(Slot& slot)
+  {
+    this->lru.splice(this->lru.begin(), this->lru, slot.lru);
+  }
+
+  void evict()
+  {
+    while(this->used > this->budget && !this->lru.empty())
+    {
+      auto it = this->slots.find(this->lru.back());
+      this->used -= it->second.bytes;
+      this->slots.erase(it);
+      this->lru.pop_back();
+      this->evictions++;
+    }
+  }
+
+public:
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+
+  SuccExistCache(size_t budget = DefaultBudget) : slots(), lru(), budget(budget), used(0),
+    hits(0), misses(0), evictions(0) { }
+
+  void setBudget(size_t budget)
+  {
+    this->budget = budget;
+    this->evict();
+  }
+
+  /*
+   * Get the existence of a tight successor from the cache
+   * @param key Id of the S-set, symbol and maximum rank
+   * @param f Ranking function
+   * @param out Out parameter to store the existence of successors
+   * @return Is the existence determined by the cache?
+   */
+  bool find(const Key& key, const RankFunc& f, bool& out)
+  {
+    auto it = this->slots.find(key);
+    if(it == this->slots.end())
+    {
+      this->misses++;
+      return false;
+    }
+    Slot& slot = it->second;
+    this->touch(slot);
+    PackedRank act = PackedRank::fromRank(f);
+
+    // an entry with a successor below f (sum not greater)
+    auto bound = std::upper_bound(slot.exists.begin(), slot.exists.end(), act, PackedRank::lessSum);
+    for(auto e = slot.exists.begin(); e != bound; e++)
+    {
+      if(e->leq(act))
+      {
+        out = true;
+        this->hits++;
+        return true;
+      }
+    }
+    // an entry without a successor above f (sum not smaller)
+    for(auto e = std::lower_bound(slot.empty.begin(), slot.empty.end(), act, PackedRank::lessSum); e != slot.empty.end(); e++)
+    {
+      if(act.leq(*e))
+      {
+        out = false;
+        this->hits++;
+        return true;
+      }
+    }
+    this->misses++;
+    return false;
+  }
+
+  /*
+   * Store the existence of a tight successor
+   * @param key Id of the S-set, symbol and maximum rank
+   * @param f Ranking function
+   * @param exists Does f have a tight successor?
+   */
+  void insert(const Key& key, const RankFunc& f, bool exists)
+  {
+    auto ins = this->slots.insert({key, Slot()});
+    Slot& slot = ins.first->second;
+    if(ins.second)
+    {
+      this->lru.push_front(key);
+      slot.lru = this->lru.begin();
+      slot.bytes = sizeof(Slot) + sizeof(Key) + 2*sizeof(void*);
+      this->used += slot.bytes;
+    }
+    else
+    {
+      this->touch(slot);
+    }
+
+    PackedRank act = PackedRank::fromRank(f);
+    std::vector<PackedRank>& entries = exists ? slot.exists : slot.empty;
+    // keep an antichain: drop entries subsumed by the new one
+    size_t freed = 0;
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const PackedRank& e) {
+      bool sub = exists ? act.leq(e) : e.leq(act);
+      if(sub)
+        freed += entryBytes(e);
+      return sub;
+    }), entries.end());
+    size_t bytes = entryBytes(act);
+    entries.insert(std::upper_bound(entries.begin(), entries.end(), act, PackedRank::lessSum), std::move(act));
+
+    slot.bytes += bytes - freed;
+    this->used += bytes - freed;
+    this->evict();
+  }
+
+  size_t size() const
+  {
+    return this->used;
+  }
+};
+
+#endif
@@ -17,62 +17,119 @@ InFormat parseRenamedAutomaton(ifstream& os)
 }
 
 
-BuchiAutomaton<int, int> parseRenameHOA(ifstream& os, BuchiAutomaton<int, APSymbol>* orig)
+/*
+ * Copy simulations of a renamed automaton back to the original automaton
+ * @param orig Original automaton (renameAut was called on it)
+ * @param ren Renamed automaton with computed simulations
+ */
+template <typename State, typename Symbol>
+void setOrigSimulations(BuchiAutomaton<State, Symbol>* orig, BuchiAutomaton<int, int>& ren)
+{
+  vector<State>& inv = orig->getInvRenameSymbolMap();
+  set<pair<State, State>> dirSim, oddSim;
+  for(const auto& pr : ren.getDirectSim())
+    dirSim.insert({inv[pr.first], inv[pr.second]});
+  for(const auto& pr : ren.getOddRankSim())
+    oddSim.insert({inv[pr.first], inv[pr.second]});
+  orig->setDirectSim(dirSim);
+  orig->setOddRankSim(oddSim);
+}
+
+
+BuchiAutomaton<int, int> parseRenameHOA(ifstream& os, BuchiAutomaton<int, APSymbol>* orig, bool flatSim)
 {
   BuchiAutomataParser parser;
   *orig = parser.parseHoaFormat(os);
   Simulations sim;
 
-  auto ranksim = sim.directSimulation<int, APSymbol>(*orig, -1);
-  orig->setDirectSim(ranksim);
+  if(!flatSim)
+  {
+    auto ranksim = sim.directSimulation<int, APSymbol>(*orig, -1);
+    orig->setDirectSim(ranksim);
+    auto cl = set<int>();
+
+    orig->computeRankSim(cl);
+    return orig->renameAut();
+  }
+
+  BuchiAutomaton<int, int> ren = orig->renameAut();
+  ren.setDirectSim(sim.directSimulation(ren));
   auto cl = set<int>();
 
-  orig->computeRankSim(cl);
-  return orig->renameAut();
+  ren.computeRankSim(cl);
+  setOrigSimulations(orig, ren);
+  return ren;
 }
 
 
-BuchiAutomaton<int, int> parseRenameBA(ifstream& os, BuchiAutomaton<string, string>* orig)
+BuchiAutomaton<int, int> parseRenameBA(ifstream& os, BuchiAutomaton<string, string>* orig, bool flatSim)
 {
   BuchiAutomataParser parser;
   *orig = parser.parseBaFormat(os);
   Simulations sim;
 
-  auto ranksim = sim.directSimulation<string, string>(*orig, "-1");
-  orig->setDirectSim(ranksim);
-  auto cl = set<std::string>();
+  if(!flatSim)
+  {
+    auto ranksim = sim.directSimulation<string, string>(*orig, "-1");
+    orig->setDirectSim(ranksim);
+    auto cl = set<std::string>();
+
+    orig->computeRankSim(cl);
+    return orig->renameAut();
+  }
+
+  BuchiAutomaton<int, int> ren = orig->renameAut();
+  ren.setDirectSim(sim.directSimulation(ren));
+  auto cl = set<int>();
 
-  orig->computeRankSim(cl);
-  return orig->renameAut();
+  ren.computeRankSim(cl);
+  setOrigSimulations(orig, ren);
+  return ren;
 }
 
-void complementAutWrap(BuchiAutomaton<int, int>& ren, BuchiAutomaton<StateSch, int>* complOrig, BuchiAutomaton<int, int>* complRes, Stat* stats, bool delay, double w, delayVersion version, bool elevatorRank, bool eta4)
+void complementAutWrap(BuchiAutomaton<int, int>& ren, BuchiAutomaton<StateSch, int>* complOrig, BuchiAutomaton<int, int>* complRes, Stat* stats, bool delay, double w, delayVersion version, bool elevatorRank, bool eta4, unsigned threads, bool mergeTight, size_t delayBudget)
 {
   BuchiAutomatonSpec sp(ren);
   ComplOptions opt = { .cutPoint = true, .succEmptyCheck = true, .ROMinState = 8,
-      .ROMinRank = 6, .CacheMaxState = 6, .CacheMaxRank = 8, .semidetOpt = false };
+      .ROMinRank = 6, .CacheMaxState = 6, .CacheMaxRank = 8, .semidetOpt = false, .mergeTight = mergeTight,
+      .delayCycleBudget = delayBudget, .threads = threads };
   sp.setComplOptions(opt);
-  BuchiAutomaton<StateSch, int> comp;
 
-  comp = sp.complementSchReduced(delay, ren.getFinals(), w, version, elevatorRank, eta4, stats);
-  *complOrig = comp;
+  BuchiAutomaton<int, int> comp = sp.complementSchReducedIds(delay, ren.getFinals(), w, version, elevatorRank, eta4, stats);
+  // macrostates are built only if requested
+  if(complOrig != nullptr)
+  {
+    std::map<int, StateSch> labels = sp.getComplementLabels();
+    *complOrig = comp.getComplStructure(labels);
+    complOrig->setAlphabet(comp.getAlphabet());
+    complOrig->setAPPattern(comp.getAPPattern());
+  }
 
   stats->generatedStates = comp.getStates().size();
   stats->generatedTrans = comp.getTransCount();
-  stats->generatedTransitionsToTight = comp.getTransitionsToTight();
+  stats->generatedTransitionsToTight = 0;
+  for(const auto& tr : comp.getTransitions())
+  {
+    if(sp.isComplementTight(tr.first.first))
+      continue;
+    for(int d : tr.second)
+    {
+      if(sp.isComplementTight(d))
+        stats->generatedTransitionsToTight++;
+    }
+  }
 
+  // states are already numbered from 0 with no gaps; compact them after
+  // removing the useless ones
   map<int, int> id;
   for(auto al : comp.getAlphabet())
     id[al] = al;
+  comp.removeUseless();
   BuchiAutomaton<int, int> renCompl = comp.renameAutDict(id);
-  renCompl.removeUseless();
-  renCompl = renCompl.renameAutDict(id);
-
 
   stats->reachStates = renCompl.getStates().size();
   stats->reachTrans = renCompl.getTransCount();
   stats->engine = "Ranker";
-  stats->transitionsToTight = comp.getTransitionsToTight();
   stats->transitionsToTight = renCompl.getTransitionsToTight();
   stats->elevator = ren.isElevator(); // original automaton before complementation
   stats->elevatorStates = sp.elevatorStates();
@@ -142,30 +199,55 @@ void printStat(Stat& st)
   cerr << "States-before-complementation: " << st.originalStates << endl;
   cerr << "Elevator-states: " << st.elevatorStates << endl;
   cerr << "Engine: " << st.engine << endl;
+  cerr << "Rank-bound-subsets: " << st.rankBoundSubsets << endl;
+  cerr << "Rank-bound-cached: " << st.rankBoundCached << endl;
+  cerr << "Rank-bound-macrostates: " << st.rankBoundMacrostates << endl;
+  cerr << "Succ-cache-hits: " << st.succCacheHits << endl;
+  cerr << "Succ-cache-misses: " << st.succCacheMisses << endl;
+  cerr << "Succ-cache-evictions: " << st.succCacheEvictions << endl;
+  cerr << "Merged-states: " << st.mergedStates << endl;
+  cerr << "Delay-cycles: " << st.delayCycles << endl;
+  cerr << "Delay-over-budget-SCCs: " << st.delayOverBudget << endl;
   cerr << std::fixed;
   cerr << std::setprecision(2);
 
   float duration = (float)(st.duration/1000.0);
   float rest = duration;
+  // wall time, its percentage and CPU time of a phase
+  auto phase = [duration](const string& name, long wall, long cpu) {
+    cerr << name << ": " << (float)(wall/1000.0) << " " << ((float)(wall/1000.0)*100)/duration << "%";
+    if(cpu != -1)
+      cerr << " CPU " << (float)(cpu/1000.0);
+    cerr << endl;
+  };
   cerr << "Time: " << (float)(st.duration/1000.0) << endl;
   if (st.duration/1000.0 != 0.0){
-    cerr << "Waiting-part: " << (float)(st.waitingPart/1000.0) << " " << ((float)(st.waitingPart/1000.0)*100)/duration << "%" << endl;
-    rest -= (float)(st.waitingPart/1000.0);
-    cerr << "Rank-bound: " << (float)(st.rankBound/1000.0) << " " << ((float)(st.rankBound/1000.0)*100)/duration << "%" << endl;
-    rest -= (float)(st.rankBound/1000.0);
+    phase("Waiting-part", st.waitingPart, st.waitingPartCpu);
+    phase("Self-loops", st.selfLoops, st.selfLoopsCpu);
+    phase("Reach-sizes", st.reachSizes, st.reachSizesCpu);
+    phase("Rank-bound", st.rankBound, st.rankBoundCpu);
     if (st.elevatorRank != -1){
-      cerr << "Elevator-rank: " << (float)(st.elevatorRank/1000.0) << " " << ((float)(st.elevatorRank/1000.0)*100)/duration << "%" << endl;
-      rest -= (float)(st.elevatorRank/1000.0);
+      phase("Elevator-rank", st.elevatorRank, st.elevatorRankCpu);
     }
-    cerr << "Start-of-tight-part: " << (float)(st.cycleClosingStates/1000.0) << " " << ((float)(st.cycleClosingStates/1000.0)*100)/duration << "%" << endl;
-    rest -= (float)(st.cycleClosingStates/1000.0);
+    phase("Start-of-tight-part", st.cycleClosingStates, st.cycleClosingStatesCpu);
     if (st.getAllCycles != -1){
       // delay
       cerr << "\tGet-all-cycles: " << (float)(st.getAllCycles/1000.0) << " " << ((float)(st.getAllCycles/1000.0)*100)/duration << "%" << endl;
       cerr << "\tStates-to-generate: " << (float)(st.statesToGenerate/1000.0) << " " << ((float)(st.statesToGenerate/1000.0)*100)/duration << "%" << endl;
     }
-    cerr << "Simulations: " << (float)(st.simulations/1000.0) << " " << ((float)(st.simulations/1000.0)*100)/duration << "%" << endl;
-    rest -= (float)(st.simulations/1000.0);
+    phase("Simulations", st.simulations, st.simulationsCpu);
+    if (st.preprocessing != -1){
+      // the preprocessing phases may overlap
+      cerr << "Preprocessing: " << (float)(st.preprocessing/1000.0) << " " << ((float)(st.preprocessing/1000.0)*100)/duration << "%" << endl;
+      rest -= (float)(st.preprocessing/1000.0);
+    }
+    else {
+      // the phases were run one after another
+      rest -= (float)((st.waitingPart + st.selfLoops + st.reachSizes + st.rankBound +
+        st.cycleClosingStates + st.simulations)/1000.0);
+      if (st.elevatorRank != -1)
+        rest -= (float)(st.elevatorRank/1000.0);
+    }
     cerr << "Tight-part-construction: " << (float)(st.tightPart/1000.0) << " " << ((float)(st.tightPart/1000.0)*100)/duration << "%" << endl;
     rest -= (float)(st.tightPart/1000.0);
     cerr << "Rest: " << rest << " " << (rest*100.0)/duration << "%" << endl;
@@ -177,7 +259,7 @@ std::string getHelpMsg(const std::string& progName)
 	std::string helpMsg;
 	helpMsg += "Usage: \n";
   helpMsg += "1) Complementation:\n";
-  helpMsg += "  " + progName + " [--stats] [--delay VERSION [-w WEIGHT]] [--elevator-rank] [--eta4] INPUT\n";
+  helpMsg += "  " + progName + " [--stats] [--delay VERSION [-w WEIGHT] [--delay-budget N]] [--elevator-rank] [--eta4] [--threads N] [--merge-tight] INPUT\n";
 	helpMsg += "\n";
 	helpMsg += "Complements a (state-based acceptance condition) Buchi automaton.\n";
 	helpMsg += "\n";
@@ -193,9 +275,14 @@ std::string getHelpMsg(const std::string& progName)
   helpMsg += "  --delay             Use delay optimization\n";
   helpMsg += "  VERSION             --old / --new / --random / --subset / --stirling\n";
   helpMsg += "  WEIGHT              Weight parameter - in <0,1>\n";
+  helpMsg += "  --delay-budget N    Maximum number of cycles enumerated in an SCC by delay\n";
+  helpMsg += "                      (0 = unlimited)\n";
   helpMsg += "  --elevator-rank     Update rank upper bound of each macrostate based on elevator automaton structure";
   helpMsg += "  --eta4              Max rank optimization - eta 4 only when going from some accepting state";
   helpMsg += "  --check=<word>      Product of the complementary automaton with the word\n";
+  helpMsg += "  --threads N         Number of threads constructing the tight part\n";
+  helpMsg += "  --merge-tight       Merge tight macrostates with the same acceptance and\n";
+  helpMsg += "                      the same transitions\n";
   helpMsg += "\n\n";
   helpMsg += "2) Tests if INPUT is an elevator automaton\n";
   helpMsg += "  " + progName + " --elevator-test INPUT\n";
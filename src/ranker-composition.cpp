@@ -143,7 +143,6 @@ int main(int argc, char *argv[])
     BuchiAutomaton<int, APSymbol> ba;
     BuchiAutomaton<int, int> ren;
     BuchiAutomaton<int, int> renCompl;
-    BuchiAutomaton<StateSch, int> comp;
     Stat stats;
     try
     {
@@ -207,7 +206,7 @@ int main(int argc, char *argv[])
     {
       try
       {
-        complementAutWrap(ren, &comp, &renCompl, &stats, delay, w, version, elevatorRank, eta4);
+        complementAutWrap(ren, nullptr, &renCompl, &stats, delay, w, version, elevatorRank, eta4);
       }
       catch (const std::bad_alloc&)
       {
@@ -238,8 +237,9 @@ bool suitCase(BuchiAutomatonSpec& sp)
   set<StateSch> slIgnore = sp.nfaSlAccept(comp);
 
   auto maxReach = sp.getMaxReachSize(comp, slIgnore);
-  auto minReach = sp.getMinReachSize();
-  auto maxReachInd = sp.getMaxReachSizeInd();
+  map<int, int> minReach;
+  map<int, int> maxReachInd;
+  sp.getReachSizes(minReach, maxReachInd);
 
   auto slnoAccept = sp.nfaSingleSlNoAccept(comp);
   set<StateSch> ignoreAll;
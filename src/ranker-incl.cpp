@@ -0,0 +1,232 @@
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <map>
+#include <fstream>
+#include <chrono>
+#include <iomanip>
+#include "args.hxx" // argument parsing
+
+#include "Ranker-general.h"
+#include "Complement/Options.h"
+#include "Complement/BuchiAutomatonSpec.h"
+#include "Algorithms/AuxFunctions.h"
+#include "Algorithms/InclusionCheck.h"
+#include "Automata/BuchiAutomaton.h"
+#include "Automata/BuchiAutomataParser.h"
+#include "Algorithms/Simulations.h"
+
+using namespace std;
+
+/*
+ * Print an ultimately periodic word in the format of HOA words
+ * @param prefix Prefix of the word
+ * @param loop Loop of the word
+ * @param names Names of the symbols
+ * @return String representation prefix;cycle{loop}
+ */
+string wordToString(const vector<int>& prefix, const vector<int>& loop, map<int, string>& names)
+{
+  string ret;
+  for(int sym : prefix)
+    ret += names[sym] + ";";
+  ret += "cycle{";
+  for(size_t i = 0; i < loop.size(); i++)
+    ret += names[loop[i]] + (i + 1 < loop.size() ? ";" : "");
+  return ret + "}";
+}
+
+
+/*
+ * Name of an AP symbol (conjunction of all APs)
+ * @param sym Symbol
+ * @param aps Mapping of AP names to indices
+ * @return AP symbol in the format of HOA words
+ */
+string apSymbolToString(const APSymbol& sym, map<string, int>& aps)
+{
+  string ret;
+  for(const auto& ap : Aux::reverseMap(aps))
+  {
+    if(ret.size() > 0)
+      ret += "&";
+    ret += (sym.ap[ap.first] ? "" : "!") + ap.second;
+  }
+  return ret;
+}
+
+
+/*
+ * Both automata renamed over the union of their alphabets
+ */
+template <typename Symbol>
+struct RenamedUnion
+{
+  BuchiAutomaton<int, int> a;
+  BuchiAutomaton<int, int> b;
+  map<int, Symbol> names;
+};
+
+
+/*
+ * Rename both automata over the union of their alphabets
+ * @param a Automaton A
+ * @param b Automaton B
+ * @return Renamed automata and the mapping of new symbols to original ones
+ */
+template <typename State, typename Symbol>
+RenamedUnion<Symbol> renameUnion(BuchiAutomaton<State, Symbol>& a, BuchiAutomaton<State, Symbol>& b)
+{
+  set<Symbol> alph = a.getAlphabet();
+  alph.insert(b.getAlphabet().begin(), b.getAlphabet().end());
+  map<Symbol, int> dict;
+  set<int> ralph;
+  for(const Symbol& s : alph)
+  {
+    ralph.insert(dict.size());
+    dict.insert({s, dict.size()});
+  }
+
+  RenamedUnion<Symbol> ret = { a.renameAutDict(dict), b.renameAutDict(dict), Aux::reverseMap(dict) };
+  ret.a.setAlphabet(ralph);
+  ret.b.setAlphabet(ralph);
+  return ret;
+}
+
+
+/*
+ * Check the inclusion L(A) \subseteq L(B) and print the result
+ * @param renA Renamed automaton A
+ * @param renB Renamed automaton B (with simulations)
+ * @param names Names of the renamed symbols
+ * @param stats Statistics (beginning already set)
+ * @param printStats Print summary statistics
+ * @param subsumption Prune subsumed product states
+ * @return Return code of the program
+ */
+int checkInclusion(BuchiAutomaton<int, int>& renA, BuchiAutomaton<int, int>& renB, map<int, string>& names,
+  Stat& stats, bool printStats, bool subsumption)
+{
+  BuchiAutomatonSpec sp(renB);
+  ComplOptions opt = { .cutPoint = true, .succEmptyCheck = true, .ROMinState = 8,
+      .ROMinRank = 6, .CacheMaxState = 6, .CacheMaxRank = 8, .semidetOpt = false };
+  sp.setComplOptions(opt);
+
+  InclusionCheck check(renA, renB, sp);
+  bool included;
+  try
+  {
+    included = check.isIncluded(&stats, subsumption);
+  }
+  catch (const std::bad_alloc&)
+  {
+    cerr << "Memory error" << endl;
+    return 2;
+  }
+
+  stats.end = std::chrono::high_resolution_clock::now();
+  stats.duration = std::chrono::duration_cast<std::chrono::milliseconds>(stats.end - stats.beginning).count();
+
+  cout << "Included: " << (included ? "true" : "false") << endl;
+  if(!included)
+    cout << "Counterexample: " << wordToString(check.getPrefix(), check.getLoop(), names) << endl;
+  if(printStats)
+  {
+    cerr << "Product-states: " << check.getExplored() << endl;
+    cerr << "Pruned-states: " << check.getPruned() << endl;
+    cerr << "Exact-fallback: " << (check.usedFallback() ? "Yes" : "No") << endl;
+    cerr << std::fixed << std::setprecision(2);
+    cerr << "Time: " << (float)(stats.duration/1000.0) << endl;
+  }
+  return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+  Stat stats;
+  ifstream osA;
+  ifstream osB;
+  BuchiAutomataParser parser;
+
+  args::ArgumentParser argparser("Program checking language inclusion of (state-based acceptance condition) Buchi automata L(A) \\subseteq L(B).\n", "");
+  args::HelpFlag help(argparser, "help", "Display this help menu", {'h', "help"});
+  args::Positional<std::string> inputA(argparser, "A", "The name of a file with the automaton A (HOA or BA format)");
+  args::Positional<std::string> inputB(argparser, "B", "The name of a file with the automaton B (the same format as A)");
+  args::Flag statsFlag(argparser, "", "Print summary statistics", {"stats"});
+  args::Flag noSubsFlag(argparser, "", "Do not prune subsumed product states", {"no-subsumption"});
+
+  try
+  {
+      argparser.ParseCLI(argc, argv);
+  }
+  catch (args::Help&)
+  {
+      std::cerr << argparser;
+      return 0;
+  }
+  catch (args::ParseError& e)
+  {
+      std::cerr << e.what() << std::endl;
+      std::cerr << argparser;
+      return 1;
+  }
+  if(!inputA || !inputB)
+  {
+    std::cerr << argparser;
+    return 1;
+  }
+
+  osA.open(args::get(inputA));
+  osB.open(args::get(inputB));
+  if(!osA || !osB)
+  {
+    std::cerr << "Cannot open input files" << std::endl;
+    return 1;
+  }
+
+  stats.beginning = std::chrono::high_resolution_clock::now();
+  try
+  {
+    InFormat fmtA = parseRenamedAutomaton(osA);
+    InFormat fmtB = parseRenamedAutomaton(osB);
+    if(fmtA != fmtB)
+    {
+      std::cerr << "Both automata have to be in the same format" << std::endl;
+      return 1;
+    }
+
+    if(fmtA == BA)
+    {
+      BuchiAutomaton<string, string> a = parser.parseBaFormat(osA);
+      BuchiAutomaton<string, string> b;
+      // simulations of B are used in the complementation
+      parseRenameBA(osB, &b);
+      RenamedUnion<string> ren = renameUnion(a, b);
+      return checkInclusion(ren.a, ren.b, ren.names, stats, statsFlag, !noSubsFlag);
+    }
+    else
+    {
+      BuchiAutomaton<int, APSymbol> a = parser.parseHoaFormat(osA);
+      BuchiAutomaton<int, APSymbol> b;
+      parseRenameHOA(osB, &b);
+      map<string, int> aps = a.getAPPattern();
+      if(aps != b.getAPPattern())
+      {
+        std::cerr << "Both automata have to use the same atomic propositions" << std::endl;
+        return 1;
+      }
+      RenamedUnion<APSymbol> ren = renameUnion(a, b);
+      map<int, string> names;
+      for(const auto& pr : ren.names)
+        names[pr.first] = apSymbolToString(pr.second, aps);
+      return checkInclusion(ren.a, ren.b, names, stats, statsFlag, !noSubsFlag);
+    }
+  }
+  catch(const ParserException& e)
+  {
+    cerr << "Parser error:" << endl;
+    cerr << "line " << e.getLine() << ": " << e.what() << endl;
+    return 2;
+  }
+}
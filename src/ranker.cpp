@@ -30,6 +30,9 @@ int main(int argc, char *argv[])
   bool elevatorTest = false;
   bool elevatorRank = false;
   bool eta4 = false;
+  unsigned threads = 1;
+  bool mergeTight = false;
+  size_t delayBudget = ComplOptions().delayCycleBudget;
 
   args::ArgumentParser parser("Program complementing a (state-based acceptance condition) Buchi automaton.\n", "");
   args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
@@ -38,10 +41,13 @@ int main(int argc, char *argv[])
   args::Flag statsFlag(parser, "", "Print summary statistics", {"stats"});
   args::ValueFlag<std::string> delayFlag(parser, "version", "Use delay optimization, versions: old, new, random, subset, stirling", {"delay"});
   args::ValueFlag<std::string> checkFlag(parser, "word", "Product of the result with a given word", {"check"});
+  args::ValueFlag<size_t> delayBudgetFlag(parser, "N", "Maximum number of cycles enumerated in an SCC by delay (0 = unlimited)", {"delay-budget"});
   args::ValueFlag<double> weightFlag(parser, "value", "Weight parameter for delay - value in <0,1>", {'w', "weight"});
   args::Flag elevatorFlag(parser, "elevator rank", "Update rank upper bound of each macrostate based on elevator automaton structure", {"elevator-rank"});
   args::Flag eta4Flag(parser, "eta4", "Max rank optimization - eta 4 only when going from some accepting state", {"eta4"});
   args::Flag elevatorTestFlag(parser, "elevator test", "Test if INPUT is an elevator automaton", {"elevator-test"});
+  args::ValueFlag<unsigned> threadsFlag(parser, "N", "Number of threads constructing the tight part", {"threads"});
+  args::Flag mergeTightFlag(parser, "merge tight", "Merge tight macrostates with the same acceptance and the same transitions", {"merge-tight"});
 
   try
   {
@@ -113,6 +119,15 @@ int main(int argc, char *argv[])
     }
   }
 
+  // cycle budget for delay
+  if (delayBudgetFlag){
+    if (not delayFlag){
+      std::cerr << "Wrong combination of arguments" << std::endl;
+      return 1;
+    }
+    delayBudget = args::get(delayBudgetFlag);
+  }
+
   // elevator rank
   if (elevatorFlag){
     elevatorRank = true;
@@ -123,6 +138,20 @@ int main(int argc, char *argv[])
     eta4 = true;
   }
 
+  // threads
+  if (threadsFlag){
+    threads = args::get(threadsFlag);
+    if (threads == 0) {
+      std::cerr << "Wrong number of threads" << std::endl;
+      return 1;
+    }
+  }
+
+  // merging of tight macrostates
+  if (mergeTightFlag){
+    mergeTight = true;
+  }
+
   if (elevatorTestFlag){
     elevatorTest = true;
     if (statsFlag or delayFlag or weightFlag or elevatorFlag or eta4Flag){
@@ -158,7 +187,7 @@ int main(int argc, char *argv[])
 
       try
       {
-        complementAutWrap(ren, &comp, &renCompl, &stats, delay, w, version, elevatorRank, eta4);
+        complementAutWrap(ren, nullptr, &renCompl, &stats, delay, w, version, elevatorRank, eta4, threads, mergeTight, delayBudget);
       }
       catch (const std::bad_alloc&)
       {
@@ -200,7 +229,7 @@ int main(int argc, char *argv[])
 
       try
       {
-        complementAutWrap(ren, &comp, &renCompl, &stats, delay, w, version, elevatorRank, eta4);
+        complementAutWrap(ren, (params.checkWord.size() > 0 ? &comp : nullptr), &renCompl, &stats, delay, w, version, elevatorRank, eta4, threads, mergeTight, delayBudget);
       }
       catch (const std::bad_alloc&)
       {
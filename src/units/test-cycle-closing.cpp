@@ -0,0 +1,66 @@
+#include <iostream>
+#include <set>
+#include <map>
+#include <vector>
+
+#include "../Automata/BuchiAutomaton.h"
+
+using namespace std;
+
+/*
+ * Does removing the selected states break every cycle of the automaton
+ */
+bool breaksCycles(BuchiAutomaton<int, int>& ba, const set<int>& sel)
+{
+  // repeatedly remove states without a successor among the remaining ones
+  set<int> rest;
+  for(int st : ba.getStates())
+  {
+    if(sel.find(st) == sel.end())
+      rest.insert(st);
+  }
+  bool changed = true;
+  while(changed)
+  {
+    changed = false;
+    for(int st : set<int>(rest))
+    {
+      bool succ = false;
+      for(int a : ba.getAlphabet())
+      {
+        auto it = ba.getTransitions().find({st, a});
+        if(it == ba.getTransitions().end())
+          continue;
+        for(int d : it->second)
+          succ = succ || rest.find(d) != rest.end();
+      }
+      if(!succ)
+      {
+        rest.erase(st);
+        changed = true;
+      }
+    }
+  }
+  return rest.empty();
+}
+
+
+int main()
+{
+  // the single DFS alone selects {1, 2, 3} here, the restricted search {0, 1}
+  map<pair<int, int>, set<int>> trans = {
+    {{0, 0}, {3}}, {{0, 1}, {1, 2, 3}}, {{0, 2}, {1, 3}},
+    {{1, 0}, {1}}, {{1, 1}, {0, 3}}, {{1, 2}, {1, 2, 3}},
+    {{2, 0}, {1}}, {{2, 2}, {0}},
+    {{3, 0}, {0, 1}}, {{3, 1}, {0, 1}}, {{3, 2}, {0, 2}}
+  };
+  BuchiAutomaton<int, int> ba({0, 1, 2, 3}, {}, {0}, trans, {0, 1, 2});
+
+  set<int> ignore;
+  set<int> closing = ba.getCycleClosingStates(ignore);
+
+  bool res = closing.size() <= 2 && breaksCycles(ba, closing);
+  cout << std::boolalpha;
+  cout << "Cycle closing states: " << res << endl;
+  return res ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <set>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "units-config.h"
+#include "../Automata/BuchiAutomaton.h"
+#include "../Automata/BuchiAutomataParser.h"
+#include "../Algorithms/Simulations.h"
+
+using namespace std;
+
+/*
+ * Split a string by a delimiter
+ */
+vector<string> split(const string& str, char delim)
+{
+  vector<string> ret;
+  string item;
+  istringstream ss(str);
+  while(getline(ss, item, delim))
+    ret.push_back(item);
+  return ret;
+}
+
+
+/*
+ * Is an ultimately periodic word accepted by an automaton (nonemptiness of
+ * the product with an automaton accepting only the word; independent of the
+ * lasso check of the inclusion)
+ * @param aut Buchi automaton
+ * @param prefix Prefix of the word
+ * @param loop Loop of the word (nonempty)
+ * @return Is the word accepted
+ */
+bool acceptsWord(BuchiAutomaton<int, int>& aut, const vector<int>& prefix, const vector<int>& loop)
+{
+  vector<int> word(prefix);
+  word.insert(word.end(), loop.begin(), loop.end());
+  set<int> states;
+  map<pair<int, int>, set<int>> trans;
+  for(int i = 0; i < (int)word.size(); i++)
+  {
+    states.insert(i);
+    int next = i + 1 < (int)word.size() ? i + 1 : prefix.size();
+    trans[{i, word[i]}].insert(next);
+  }
+  BuchiAutomaton<int, int> lasso(states, states, {0}, trans, aut.getAlphabet());
+
+  auto prod = aut.productBA(lasso);
+  map<int, int> id;
+  for(int a : aut.getAlphabet())
+    id[a] = a;
+  BuchiAutomaton<int, int> renProd = prod.renameAutDict(id);
+  return !renProd.isEmpty();
+}
+
+
+/*
+ * Run ranker-incl on a pair of automata and check its output. If the
+ * inclusion does not hold, the printed lasso has to be accepted by A and
+ * rejected by B.
+ * @param exe Path to ranker-incl
+ * @param fileA File with the automaton A
+ * @param fileB File with the automaton B
+ * @param included Expected result of the inclusion check
+ * @return Is the output correct
+ */
+bool checkPair(const string& exe, const string& fileA, const string& fileB, bool included)
+{
+  BuchiAutomataParser parser;
+  ifstream osA(fileA);
+  ifstream osB(fileB);
+  if(!osA || !osB)
+  {
+    cerr << "Opening file error" << endl;
+    return false;
+  }
+  BuchiAutomaton<string, string> a = parser.parseBaFormat(osA);
+  BuchiAutomaton<string, string> b = parser.parseBaFormat(osB);
+
+  set<string> alph = a.getAlphabet();
+  alph.insert(b.getAlphabet().begin(), b.getAlphabet().end());
+  map<string, int> dict;
+  for(const string& s : alph)
+    dict.insert({s, dict.size()});
+  BuchiAutomaton<int, int> renA = a.renameAutDict(dict);
+  BuchiAutomaton<int, int> renB = b.renameAutDict(dict);
+
+  string cmd = exe + " " + fileA + " " + fileB;
+  istringstream out(Simulations::execCmd(cmd));
+  string line;
+  getline(out, line);
+  if(line != string("Included: ") + (included ? "true" : "false"))
+    return false;
+  if(included)
+    return true;
+
+  getline(out, line);
+  string pref = "Counterexample: ";
+  if(line.compare(0, pref.size(), pref) != 0)
+    return false;
+  string word = line.substr(pref.size());
+  size_t cycle = word.find("cycle{");
+  if(cycle == string::npos || word.back() != '}')
+    return false;
+
+  vector<int> prefix, loop;
+  for(const string& sym : split(word.substr(0, cycle), ';'))
+    prefix.push_back(dict.at(sym));
+  for(const string& sym : split(word.substr(cycle + 6, word.size() - cycle - 7), ';'))
+    loop.push_back(dict.at(sym));
+  if(loop.empty())
+    return false;
+
+  return acceptsWord(renA, prefix, loop) && !acceptsWord(renB, prefix, loop);
+}
+
+
+int main(int argc, char *argv[])
+{
+  // ranker-incl and the examples are located relative to this program
+  string self = argc > 0 ? argv[0] : "";
+  size_t slash = self.rfind('/');
+  string dir = slash == string::npos ? "." : self.substr(0, slash);
+  string exe = dir + "/../ranker-incl";
+  string examples = dir + "/../../examples/";
+
+  vector<tuple<string, string, bool>> pairs = {
+    {"A4.ba", "A9.ba", true},
+    {"A11.ba", "A3.ba", true},
+    {"A4.ba", "A3.ba", false},
+    {"A9.ba", "A11.ba", false},
+    {"A3.ba", "A11.ba", false}
+  };
+
+  bool ok = true;
+  cout << std::boolalpha;
+  for(const auto& t : pairs)
+  {
+    bool res = checkPair(exe, examples + get<0>(t), examples + get<1>(t), get<2>(t));
+    cout << get<0>(t) << " " << get<1>(t) << ": " << res << endl;
+    ok = ok && res;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "../Automata/BuchiAutomaton.h"
+#include "../Complement/RankingCounts.h"
+
+using namespace std;
+
+/*
+ * Reference implementation of the formulas of the removed
+ * BuchiAutomatonDelay::getAllPossibleRankings (in signed 64-bit arithmetic,
+ * so that the alternating sums of the stirling version do not wrap).
+ */
+long long fact(int n)
+{
+  long long res = 1;
+  for(int i = 2; i <= n; i++)
+    res = res * i;
+  return res;
+}
+
+long long nCr(int n, int r)
+{
+  return fact(n) / (fact(r) * fact(n - r));
+}
+
+long long power(long long base, unsigned exp)
+{
+  long long res = 1;
+  for(unsigned i = 0; i < exp; i++)
+    res *= base;
+  return res;
+}
+
+long long chain(int upperBound, int nonAccStates, int k, int iterations)
+{
+  long long tmpSum = 1;
+  long long odd = 0;
+  for(int r = 0; r < iterations; r++)
+  {
+    int innerUpperBound = nonAccStates - k + 1 + r;
+    long long tmp = 0;
+    for(int i = 1; i <= upperBound; i++)
+      tmp += nCr(innerUpperBound, i) * tmpSum;
+    tmpSum = tmp;
+    odd = tmp;
+  }
+  return odd;
+}
+
+long long getAllPossibleRankings(int maxRank, int accStates, int nonAccStates, delayVersion version)
+{
+  long long even = power((maxRank + 1)/2, accStates);
+  if(version == oldVersion)
+  {
+    int k = (maxRank - 1)/2;
+    return chain(nonAccStates - k, nonAccStates, k, k + 1) * even;
+  }
+  else if(version == newVersion || version == subsetVersion)
+  {
+    long long oddSum = 0;
+    for(int count = 0; count < (maxRank + 1)/2; count++)
+    {
+      int rank = 2*count + 1;
+      int k = (rank - 1)/2;
+      if(nonAccStates < k)
+        continue;
+      long long odd = (rank == 1 && nonAccStates > 0) ? 1 : 0;
+      if(k > 0)
+        odd = chain(nonAccStates - k, nonAccStates, k, k);
+      oddSum += odd;
+    }
+    return oddSum * even;
+  }
+  else
+  {
+    long long odd = 0;
+    for(int count = 1; count <= (maxRank + 1)/2; count++)
+    {
+      for(int i = 0; i <= count; i++)
+        odd += (i % 2 == 1 ? -1 : 1) * nCr(count, i) * power(count - i, nonAccStates);
+    }
+    return odd * even;
+  }
+}
+
+
+int main()
+{
+  const unsigned maxRank = 9;
+  const unsigned maxStates = 6;
+  vector<delayVersion> versions = {oldVersion, newVersion, randomVersion, subsetVersion, stirlingVersion};
+
+  bool ok = true;
+  for(delayVersion version : versions)
+  {
+    RankingCounts counts(version, maxRank, maxStates);
+    unsigned bad = 0;
+    for(unsigned rank = 1; rank <= maxRank; rank++)
+    {
+      for(unsigned acc = 0; acc <= maxStates; acc++)
+      {
+        for(unsigned nonAcc = 0; nonAcc <= maxStates; nonAcc++)
+        {
+          // the old formula is not defined for fewer states than odd ranks
+          if(version == oldVersion && nonAcc < (rank - 1)/2)
+            continue;
+          long long ref = getAllPossibleRankings(rank, acc, nonAcc, version);
+          if(counts.get(rank, acc, nonAcc) != (RankingCounts::Count)ref)
+          {
+            cerr << "version " << version << ": " << rank << " " << acc << " " << nonAcc
+              << " expected " << ref << endl;
+            bad++;
+          }
+        }
+      }
+    }
+    cout << "Version " << version << ": " << (bad == 0 ? "true" : "false") << endl;
+    ok = ok && bad == 0;
+  }
+  return ok ? 0 : 1;
+}